@@ -22,11 +22,13 @@
  * THE SOFTWARE.
  */
 #include <cctype>
+#include <limits>
 
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
 #include <graphene/app/application.hpp>
 #include <graphene/app/impacted.hpp>
+#include <graphene/account_history/account_history_plugin.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/get_config.hpp>
 #include <graphene/utilities/key_conversion.hpp>
@@ -140,6 +142,33 @@ namespace graphene { namespace app {
        return res;
     }
 
+    raw_block_range block_api::get_raw_blocks(uint32_t block_num_from, uint32_t limit)const
+    {
+       FC_ASSERT( limit <= 1000 );
+       raw_block_range result;
+       const uint32_t head_block_num = _db.head_block_num();
+       uint32_t block_num = std::max( block_num_from, uint32_t(1) );
+       uint64_t size = 0;
+       for( ; block_num <= head_block_num && result.blocks.size() < limit; ++block_num )
+       {
+          // the bytes are copied once out of the mapped block log, and never unpacked
+          block_view view = _db.fetch_block_view_by_number( block_num );
+          // a page never skips a block, so that callers may rely on the blocks being consecutive
+          if( !view.valid() )
+             break;
+          if( !result.blocks.empty() && size + view.size() > max_raw_blocks_size )
+             break;
+          size += view.size();
+          raw_block raw;
+          raw.block_num = block_num;
+          raw.id = view.id();
+          raw.data.assign( view.data(), view.data() + view.size() );
+          result.blocks.push_back( std::move(raw) );
+       }
+       result.next_block_num = block_num;
+       return result;
+    }
+
     network_broadcast_api::network_broadcast_api(application& a):_app(a)
     {
        _applied_block_connection = _app.chain_database()->applied_block.connect([this](const signed_block& b){ on_applied_block(b); });
@@ -572,6 +601,43 @@ namespace graphene { namespace app {
        return result;
     }
 
+    /** @return the most recent history entry of account whose operation is not after op */
+    static const account_transaction_history_object* find_history_at_or_before( const database& db, account_id_type account,
+                                                                               operation_history_id_type op )
+    {
+       const auto& by_op_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_op>();
+       auto itr = by_op_idx.upper_bound( boost::make_tuple( account, op ) );
+       if( itr == by_op_idx.begin() )
+          return nullptr;
+       --itr;
+       return itr->account == account ? &*itr : nullptr;
+    }
+
+    /** @return the number of the first block produced at or after time, or the next block number if there is none */
+    static uint32_t first_block_at_or_after( const database& db, fc::time_point_sec time )
+    {
+       uint32_t low = 1;
+       uint32_t high = db.head_block_num() + 1;
+       while( low < high )
+       {
+          uint32_t middle = low + ( high - low ) / 2;
+          optional<signed_block> block = db.fetch_block_by_number( middle );
+          if( block.valid() && block->timestamp >= time )
+             high = middle;
+          else
+             low = middle + 1;
+       }
+       return low;
+    }
+
+    static const graphene::account_history::operation_type_history_index* operation_type_history( const application& app )
+    {
+       // the typed get_plugin() asserts that the plugin exists, an app may run without account_history
+       auto plugin = std::dynamic_pointer_cast<graphene::account_history::account_history_plugin>(
+             app.get_plugin( "account_history" ) );
+       return plugin ? plugin->operation_type_history() : nullptr;
+    }
+
     vector<operation_history_object> history_api::get_account_history_operations( account_id_type account,
                                                                        int operation_id,
                                                                        operation_history_id_type start,
@@ -588,6 +654,17 @@ namespace graphene { namespace app {
        if( start == operation_history_id_type() )
           start = node->operation_id;
 
+       const auto* by_type = operation_type_history( _app );
+       if( by_type != nullptr )
+       {
+          const account_transaction_history_object* last = find_history_at_or_before( db, account, start );
+          if( last == nullptr )
+             return result;
+          for( const operation_history_id_type& id : by_type->find_by_sequence( account, operation_id, last->sequence, stop, limit ) )
+             result.push_back( id(db) );
+          return result;
+       }
+
        while(node && node->operation_id.instance.value > stop.instance.value && result.size() < limit)
        {
           if( node->operation_id.instance.value <= start.instance.value ) {
@@ -602,6 +679,57 @@ namespace graphene { namespace app {
        return result;
     }
 
+    vector<operation_history_object> history_api::get_account_history_by_time( account_id_type account,
+                                                                               int operation_type,
+                                                                               fc::time_point_sec start,
+                                                                               fc::time_point_sec end,
+                                                                               unsigned limit,
+                                                                               operation_history_id_type from ) const
+    { try {
+       FC_ASSERT( _app.chain_database() );
+       const auto& db = *_app.chain_database();
+       FC_ASSERT( limit <= 100 );
+       vector<operation_history_object> result;
+
+       uint32_t first_block = first_block_at_or_after( db, start );
+       uint32_t end_block = first_block_at_or_after( db, end );
+       uint32_t max_sequence = std::numeric_limits<uint32_t>::max();
+       if( from != operation_history_id_type() )
+       {
+          const account_transaction_history_object* last = find_history_at_or_before( db, account, from );
+          if( last == nullptr )
+             return result;
+          max_sequence = last->sequence;
+          end_block = std::min( end_block, last->operation_id(db).block_num + 1 );
+       }
+
+       if( first_block >= end_block )
+          return result;
+
+       const auto* by_type = operation_type_history( _app );
+       if( by_type != nullptr )
+       {
+          for( const operation_history_id_type& id : by_type->find_by_block( account, operation_type, first_block, end_block,
+                                                                             max_sequence, limit ) )
+             result.push_back( id(db) );
+          return result;
+       }
+
+       // walk back from the most recent operation until the history leaves the block range
+       const auto& by_seq_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_seq>();
+       auto begin = by_seq_idx.lower_bound( boost::make_tuple( account ) );
+       auto itr = by_seq_idx.upper_bound( boost::make_tuple( account, max_sequence ) );
+       while( itr != begin && result.size() < limit )
+       {
+          --itr;
+          const operation_history_object& op = itr->operation_id(db);
+          if( op.block_num < first_block )
+             break;
+          if( op.block_num < end_block && ( operation_type < 0 || op.op.which() == operation_type ) )
+             result.push_back( op );
+       }
+       return result;
+    } FC_CAPTURE_AND_RETHROW( (account)(operation_type)(start)(end)(limit)(from) ) }
 
     vector<operation_history_object> history_api::get_relative_account_history( account_id_type account,
                                                                                 uint32_t stop,
@@ -786,34 +914,19 @@ namespace graphene { namespace app {
     // get number of asset holders.
     int asset_api::get_asset_holders_count( asset_id_type asset_id ) const {
 
-      const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
-      auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
-
-      int count = boost::distance(range) - 1;
-
-      return count;
+      return holders_count().count( asset_id );
     }
     // function to get vector of system assets with holders count.
     vector<asset_holders> asset_api::get_all_asset_holders() const {
 
       vector<asset_holders> result;
 
-      vector<asset_id_type> total_assets;
+      const auto& holders = holders_count();
       for( const asset_object& asset_obj : _db.get_index_type<asset_index>().indices() )
       {
-        const auto& dasset_obj = asset_obj.dynamic_asset_data_id(_db);
-
-        asset_id_type asset_id;
-        asset_id = dasset_obj.id;
-
-        const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
-        auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
-
-        int count = boost::distance(range) - 1;
-
         asset_holders ah;
-        ah.asset_id       = asset_id;
-        ah.count     = count;
+        ah.asset_id       = asset_obj.id;
+        ah.count     = holders.count( asset_obj.id );
 
         result.push_back(ah);
       }
@@ -821,4 +934,10 @@ namespace graphene { namespace app {
       return result;
     }
 
+    const asset_holders_count_index& asset_api::holders_count() const {
+      const auto& idx = _db.get_index_type<account_balance_index>();
+      const auto& bidx = dynamic_cast<const primary_index<account_balance_index>&>(idx);
+      return bidx.get_secondary_index<asset_holders_count_index>();
+    }
+
 } } // graphene::app
@@ -68,6 +68,7 @@ using net::trx_message;
 using chain::block_header;
 using chain::signed_block_header;
 using chain::signed_block;
+using chain::block_view;
 using chain::block_id_type;
 
 using std::vector;
@@ -118,6 +119,8 @@ namespace detail {
 
          _p2p_network->load_configuration(data_dir / "p2p");
          _p2p_network->set_node_delegate(this);
+         if( _options->count("p2p-decoding-threads") )
+            _p2p_network->set_message_decoding_threads( _options->at("p2p-decoding-threads").as<uint32_t>() );
 
          if( _options->count("seed-node") )
          {
@@ -378,8 +381,23 @@ namespace detail {
          }
          _chain_db->add_checkpoints( loaded_checkpoints );
 
+         if( _options->count("signature-recovery-threads") )
+            _chain_db->set_signature_recovery_threads( _options->at("signature-recovery-threads").as<uint32_t>() );
+         if( _options->count("signature-cache-size") )
+            _chain_db->set_signature_key_cache_size( _options->at("signature-cache-size").as<uint32_t>() );
+         if( _options->count("settlement-threads") )
+            _chain_db->set_settlement_threads( _options->at("settlement-threads").as<uint32_t>() );
+         if( _options->count("reindex-threads") )
+            _chain_db->set_reindex_threads( _options->at("reindex-threads").as<uint32_t>() );
+         if( _options->count("object-database-load-threads") )
+            _chain_db->set_load_threads( _options->at("object-database-load-threads").as<uint32_t>() );
+         if( _options->count("state-checkpoint-interval") )
+            _chain_db->set_state_checkpoint_interval( _options->at("state-checkpoint-interval").as<uint32_t>() );
+
          bool replay = false;
          std::string replay_reason = "reason not provided";
+         // after a crash the latest state checkpoint can stand in for a full replay
+         bool resume_from_checkpoint = false;
 
          // never replay if data dir is empty
          if( fc::exists( _data_dir ) && fc::directory_iterator( _data_dir ) != fc::directory_iterator() )
@@ -393,6 +411,12 @@ namespace detail {
             {
                replay = true;
                replay_reason = "unclean shutdown detected";
+               if( fc::exists( _data_dir / "db_version" ) )
+               {
+                  std::string version_string;
+                  fc::read_file_contents( _data_dir / "db_version", version_string );
+                  resume_from_checkpoint = ( version_string == GRAPHENE_CURRENT_DB_VERSION );
+               }
             }
             else if( !fc::exists( _data_dir / "db_version" ) )
             {
@@ -427,6 +451,12 @@ namespace detail {
             }
          }
 
+         if( replay && resume_from_checkpoint && _chain_db->open_from_state_checkpoint( _data_dir / "blockchain" ) )
+         {
+            ilog( "Resumed from state checkpoint instead of replaying due to: ${reason}", ("reason", replay_reason) );
+            replay = false;
+         }
+
          if( replay )
          {
             ilog( "Replaying blockchain due to: ${reason}", ("reason", replay_reason) );
@@ -664,6 +694,19 @@ namespace detail {
         // ilog("Request for item ${id}", ("id", id));
          if( id.item_type == graphene::net::block_message_type )
          {
+            // blocks in the block log are sent as stored, without a round trip through signed_block
+            block_view view = _chain_db->fetch_block_view_by_id( id.item_hash );
+            if( view.valid() )
+            {
+               message result;
+               result.msg_type = block_message::type;
+               result.data.reserve( view.size() + sizeof(block_id_type) );
+               result.data.insert( result.data.end(), view.data(), view.data() + view.size() );
+               const auto packed_id = fc::raw::pack( view.id() );
+               result.data.insert( result.data.end(), packed_id.begin(), packed_id.end() );
+               result.size = (uint32_t)result.data.size();
+               return result;
+            }
             auto opt_block = _chain_db->fetch_block_by_id(id.item_hash);
             if( !opt_block )
                elog("Couldn't find block ${id} -- corresponding ID in our chain is ${id2}",
@@ -955,6 +998,8 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("p2p-endpoint", bpo::value<string>(), "Endpoint for P2P node to listen on")
          ("seed-node,s", bpo::value<vector<string>>()->composing(), "P2P nodes to connect to on startup (may specify multiple times)")
          ("seed-nodes", bpo::value<string>()->composing(), "JSON array of P2P nodes to connect to on startup")
+         ("p2p-decoding-threads", bpo::value<uint32_t>()->default_value(0),
+          "Number of threads that unpack and hash the blocks and transactions received from peers (0 to do it on the p2p thread)")
          ("checkpoint,c", bpo::value<vector<string>>()->composing(), "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints.")
          ("rpc-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8090"), "Endpoint for websocket RPC to listen on")
          ("rpc-tls-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8089"), "Endpoint for TLS websocket RPC to listen on")
@@ -963,6 +1008,18 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("genesis-json", bpo::value<boost::filesystem::path>(), "File to read Genesis State from")
          ("dbg-init-key", bpo::value<string>(), "Block signing key to use for init witnesses, overrides genesis file")
          ("api-access", bpo::value<boost::filesystem::path>(), "JSON file specifying API permissions")
+         ("signature-recovery-threads", bpo::value<uint32_t>()->default_value(0),
+          "Number of threads used to recover transaction signatures of incoming blocks in parallel (0 to recover them on the main thread)")
+         ("signature-cache-size", bpo::value<uint32_t>()->default_value(20000),
+          "Maximum number of transactions whose recovered signature keys are cached")
+         ("settlement-threads", bpo::value<uint32_t>()->default_value(0),
+          "Number of threads used to work out the payouts of a settling betting market group in parallel (0 to do it on the main thread)")
+         ("reindex-threads", bpo::value<uint32_t>()->default_value(2),
+          "Number of threads that deserialize blocks ahead of the replay during a reindex (0 to do it on the main thread)")
+         ("object-database-load-threads", bpo::value<uint32_t>()->default_value(4),
+          "Number of threads that read the object database files at startup (0 to read them on the main thread)")
+         ("state-checkpoint-interval", bpo::value<uint32_t>()->default_value(0),
+          "Write the chain state to disk every N blocks once they are irreversible, so that a crashed node only replays the blocks after it (0 to disable). The changed indexes are serialized while the checkpoint block is applied, which delays that block and, on a witness, block production; the result is held in memory until that block is irreversible")
          ;
    command_line_options.add(configuration_file_options);
    command_line_options.add_options()
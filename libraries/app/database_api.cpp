@@ -148,6 +148,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       bool verify_account_authority( const string& name_or_id, const flat_set<public_key_type>& signers )const;
       processed_transaction validate_transaction( const signed_transaction& trx )const;
       vector< fc::variant > get_required_fees( const vector<operation>& ops, asset_id_type id )const;
+      signature_key_cache_stats get_signature_key_cache_stats()const;
 
       // Proposed transactions
       vector<proposal_object> get_proposed_transactions( account_id_type id )const;
@@ -220,7 +221,11 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       void on_objects_removed(const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts);
       void on_applied_block();
 
+      /** object change signals are only connected, and impacted accounts only requested, while they are used */
+      void update_subscriptions();
+
       bool _notify_remove_create = false;
+      bool _impacted_accounts_listener = false;
       mutable fc::bloom_filter _subscribe_filter;
       std::set<account_id_type> _subscribed_accounts;
       std::function<void(const fc::variant&)> _subscribe_callback;
@@ -250,15 +255,6 @@ database_api::~database_api() {}
 database_api_impl::database_api_impl( graphene::chain::database& db ):_db(db)
 {
    wlog("creating database api ${x}", ("x",int64_t(this)) );
-   _new_connection = _db.new_objects.connect([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) {
-                                on_objects_new(ids, impacted_accounts);
-                                });
-   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) {
-                                on_objects_changed(ids, impacted_accounts);
-                                });
-   _removed_connection = _db.removed_objects.connect([this](const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts) {
-                                on_objects_removed(ids, objs, impacted_accounts);
-                                });
    _applied_block_connection = _db.applied_block.connect([this](const signed_block&){ on_applied_block(); });
 
    _pending_trx_connection = _db.on_pending_transaction.connect([this](const signed_transaction& trx ){
@@ -271,6 +267,33 @@ database_api_impl::~database_api_impl()
    elog("freeing database api ${x}", ("x",int64_t(this)) );
 }
 
+void database_api_impl::update_subscriptions()
+{
+   const bool subscribed = _subscribe_callback || !_market_subscriptions.empty();
+   // impacted accounts are only looked at for accounts subscribed through get_full_accounts()
+   const bool wants_accounts = _subscribe_callback && !_subscribed_accounts.empty();
+   if( subscribed && ( !_new_connection.connected() || wants_accounts != _impacted_accounts_listener ) )
+   {
+      _new_connection = _db.connect_new_objects([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) {
+                                   on_objects_new(ids, impacted_accounts);
+                                   }, wants_accounts);
+      _change_connection = _db.connect_changed_objects([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) {
+                                   on_objects_changed(ids, impacted_accounts);
+                                   }, wants_accounts);
+      _removed_connection = _db.connect_removed_objects([this](const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts) {
+                                   on_objects_removed(ids, objs, impacted_accounts);
+                                   }, wants_accounts);
+      _impacted_accounts_listener = wants_accounts;
+   }
+   else if( !subscribed && _new_connection.connected() )
+   {
+      _new_connection.disconnect();
+      _change_connection.disconnect();
+      _removed_connection.disconnect();
+      _impacted_accounts_listener = false;
+   }
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Objects                                                          //
@@ -331,6 +354,7 @@ void database_api_impl::set_subscribe_callback( std::function<void(const variant
    param.maximum_size = 1024*8*8*2;
    param.compute_optimal_parameters();
    _subscribe_filter = fc::bloom_filter(param);
+   update_subscriptions();
 }
 
 void database_api::set_pending_transaction_callback( std::function<void(const variant&)> cb )
@@ -362,6 +386,7 @@ void database_api_impl::cancel_all_subscriptions()
 {
    set_subscribe_callback( std::function<void(const fc::variant&)>(), true);
    _market_subscriptions.clear();
+   update_subscriptions();
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -651,6 +676,7 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts( const
          FC_ASSERT( std::distance(_subscribed_accounts.begin(), _subscribed_accounts.end()) <= 100 );
          _subscribed_accounts.insert( account->get_id() );
          subscribe_to_item( account->id );
+         update_subscriptions();
       }
 
       // fc::mutable_variant_object full_account;
@@ -1196,6 +1222,7 @@ void database_api_impl::subscribe_to_market(std::function<void(const variant&)>
    if(a > b) std::swap(a,b);
    FC_ASSERT(a != b);
    _market_subscriptions[ std::make_pair(a,b) ] = callback;
+   update_subscriptions();
 }
 
 void database_api::unsubscribe_from_market(asset_id_type a, asset_id_type b)
@@ -1208,6 +1235,7 @@ void database_api_impl::unsubscribe_from_market(asset_id_type a, asset_id_type b
    if(a > b) std::swap(a,b);
    FC_ASSERT(a != b);
    _market_subscriptions.erase(std::make_pair(a,b));
+   update_subscriptions();
 }
 
 market_ticker database_api::get_ticker( const string& base, const string& quote )const
@@ -1874,6 +1902,16 @@ vector< fc::variant > database_api_impl::get_required_fees( const vector<operati
    return result;
 }
 
+signature_key_cache_stats database_api::get_signature_key_cache_stats()const
+{
+   return my->get_signature_key_cache_stats();
+}
+
+signature_key_cache_stats database_api_impl::get_signature_key_cache_stats()const
+{
+   return _db.get_signature_key_cache_stats();
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Proposed transactions                                            //
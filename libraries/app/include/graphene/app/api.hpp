@@ -86,6 +86,19 @@ namespace graphene { namespace app {
       asset_id_type   asset_id;
       int             count;
    };
+
+   struct raw_block
+   {
+      uint32_t        block_num = 0;
+      block_id_type   id;
+      vector<char>    data; ///< the signed_block as stored in the block log, packed by fc::raw
+   };
+
+   struct raw_block_range
+   {
+      vector<raw_block> blocks;
+      uint32_t          next_block_num = 0; ///< the block_num_from that continues after this page
+   };
    
    /**
     * @brief The history_api class implements the RPC API for account history
@@ -125,6 +138,26 @@ namespace graphene { namespace app {
                                                                          operation_history_id_type stop = operation_history_id_type(),
                                                                          unsigned limit = 100)const;
 
+         /**
+          * @brief Get operations relevant to the specified account that were included in blocks of a time range
+          * @param account The account whose history should be queried
+          * @param operation_type The type of the operations to retrieve, or -1 to retrieve operations of any type
+          * @param start Timestamp of the earliest block to retrieve operations from
+          * @param end Timestamp after the latest block to retrieve operations from
+          * @param limit Maximum number of operations to retrieve (must not exceed 100)
+          * @param from ID of the most recent operation to retrieve, to continue from a previous page
+          * @return A list of operations performed by account, ordered from most recent to oldest.
+          *
+          * Without the index-history-by-operation-type option of the account_history plugin, this walks the history
+          * of account back from the most recent operation, which is slow for old time ranges.
+          */
+         vector<operation_history_object> get_account_history_by_time(account_id_type account,
+                                                                      int operation_type,
+                                                                      fc::time_point_sec start,
+                                                                      fc::time_point_sec end,
+                                                                      unsigned limit = 100,
+                                                                      operation_history_id_type from = operation_history_id_type())const;
+
          /**
           * @breif Get operations relevant to the specified account referenced
           * by an event numbering specific to the account. The current number of operations
@@ -162,6 +195,19 @@ namespace graphene { namespace app {
 
       vector<optional<signed_block>> get_blocks(uint32_t block_num_from, uint32_t block_num_to)const;
 
+      /**
+       * @brief Get serialized blocks from the block log without deserializing them
+       * @param block_num_from Number of the first block to retrieve
+       * @param limit Maximum number of blocks to retrieve (must not exceed 1000)
+       * @return Consecutive blocks from block_num_from up to the head block, as many as fit into limit and
+       * max_raw_blocks_size bytes (but at least one), and the block number to continue from.  The page ends
+       * before the first block that is missing from the block log, in which case next_block_num is that block.
+       */
+      raw_block_range get_raw_blocks(uint32_t block_num_from, uint32_t limit)const;
+
+      /// the number of serialized block bytes get_raw_blocks returns at most, unless one block is larger
+      static const uint32_t max_raw_blocks_size = 4 * 1024 * 1024;
+
    private:
       graphene::chain::database& _db;
    };
@@ -341,6 +387,8 @@ namespace graphene { namespace app {
          vector<asset_holders> get_all_asset_holders() const;
 
       private:
+         const graphene::chain::asset_holders_count_index& holders_count() const;
+
          graphene::chain::database& _db;
    };
 
@@ -416,10 +464,13 @@ FC_REFLECT( graphene::app::verify_range_proof_rewind_result,
 
 FC_REFLECT( graphene::app::account_asset_balance, (name)(account_id)(amount) );
 FC_REFLECT( graphene::app::asset_holders, (asset_id)(count) );
+FC_REFLECT( graphene::app::raw_block, (block_num)(id)(data) );
+FC_REFLECT( graphene::app::raw_block_range, (blocks)(next_block_num) );
 
 FC_API(graphene::app::history_api,
        (get_account_history)
        (get_account_history_operations)
+       (get_account_history_by_time)
        (get_relative_account_history)
        (get_fill_order_history)
        (get_market_history)
@@ -428,6 +479,7 @@ FC_API(graphene::app::history_api,
      )
 FC_API(graphene::app::block_api,
        (get_blocks)
+       (get_raw_blocks)
      )
 FC_API(graphene::app::network_broadcast_api,
        (broadcast_transaction)
@@ -605,6 +605,11 @@ class database_api
        */
       vector< fc::variant > get_required_fees( const vector<operation>& ops, asset_id_type id )const;
 
+      /**
+       * @return size and hit/miss counters of this node's cache of keys recovered from transaction signatures
+       */
+      signature_key_cache_stats get_signature_key_cache_stats()const;
+
       ///////////////////////////
       // Proposed transactions //
       ///////////////////////////
@@ -753,6 +758,7 @@ FC_API(graphene::app::database_api,
    (verify_account_authority)
    (validate_transaction)
    (get_required_fees)
+   (get_signature_key_cache_stats)
 
    // Proposed transactions
    (get_proposed_transactions)
@@ -267,4 +267,65 @@ void account_referrer_index::object_modified( const object& after  )
 {
 }
 
+void asset_holders_count_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const account_balance_object*>(&obj) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(obj);
+   if( b.balance.value != 0 )
+      add_holder( b.asset_type );
+}
+
+void asset_holders_count_index::object_restored( const object& obj )
+{
+   object_inserted( obj );
+}
+
+void asset_holders_count_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const account_balance_object*>(&obj) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(obj);
+   if( b.balance.value != 0 )
+      remove_holder( b.asset_type );
+}
+
+void asset_holders_count_index::about_to_modify( const object& before )
+{
+   assert( dynamic_cast<const account_balance_object*>(&before) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(before);
+   before_asset = b.asset_type;
+   before_held = b.balance.value != 0;
+}
+
+void asset_holders_count_index::object_modified( const object& after )
+{
+   assert( dynamic_cast<const account_balance_object*>(&after) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(after);
+   bool held = b.balance.value != 0;
+   if( before_held == held && before_asset == b.asset_type )
+      return;
+   if( before_held )
+      remove_holder( before_asset );
+   if( held )
+      add_holder( b.asset_type );
+}
+
+uint32_t asset_holders_count_index::count( asset_id_type asset_id )const
+{
+   auto itr = holders.find( asset_id );
+   return itr == holders.end() ? 0 : itr->second;
+}
+
+void asset_holders_count_index::add_holder( asset_id_type asset_id )
+{
+   ++holders[asset_id];
+}
+
+void asset_holders_count_index::remove_holder( asset_id_type asset_id )
+{
+   auto itr = holders.find( asset_id );
+   assert( itr != holders.end() && itr->second > 0 );
+   if( --itr->second == 0 )
+      holders.erase( itr );
+}
+
 } } // graphene::chain
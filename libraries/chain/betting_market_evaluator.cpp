@@ -31,6 +31,7 @@
 #include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/hardfork.hpp>
 #include <graphene/chain/is_authorized_asset.hpp>
+#include <boost/range/iterator_range.hpp>
 
 namespace graphene { namespace chain {
 
@@ -169,26 +170,20 @@ void_result betting_market_group_update_evaluator::do_apply(const betting_market
       if (betting_market_group.bets_are_allowed() && 
           bets_were_delayed && !bets_are_delayed)
       {
-         const auto& bet_odds_idx = d.get_index_type<bet_object_index>().indices().get<by_odds>();
-         auto bet_iter = bet_odds_idx.begin();
-         bool last = bet_iter == bet_odds_idx.end() || !bet_iter->end_of_delay;
-         while (!last)
-         {
-            const bet_object& delayed_bet = *bet_iter;
-            ++bet_iter;
-            last = bet_iter == bet_odds_idx.end() || !bet_iter->end_of_delay;
-
-            const betting_market_object& betting_market = delayed_bet.betting_market_id(d);
-            if (betting_market.group_id == op.betting_market_group_id)
-            {
-               d.modify(delayed_bet, [](bet_object& bet_obj) {
-                  // clear the end_of_delay,  which will re-sort the bet into its place in the book
-                  bet_obj.end_of_delay.reset();
-               });
-
-               d.place_bet(delayed_bet);
-            }
-         }
+         flat_set<betting_market_id_type> markets_in_group;
+         const auto& betting_market_index = d.get_index_type<betting_market_object_index>().indices().get<by_betting_market_group_id>();
+         for (const betting_market_object& betting_market :
+              boost::make_iterator_range(betting_market_index.equal_range(op.betting_market_group_id)))
+            markets_in_group.insert(betting_market.id);
+
+         d.for_each_delayed_bet(markets_in_group, optional<time_point_sec>(), [&d](const bet_object& delayed_bet) {
+            d.modify(delayed_bet, [](bet_object& bet_obj) {
+               // clear the end_of_delay,  which will re-sort the bet into its place in the book
+               bet_obj.end_of_delay.reset();
+            });
+
+            d.place_bet(delayed_bet);
+         });
       }
    });
    return void_result();
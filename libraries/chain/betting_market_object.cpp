@@ -395,17 +395,12 @@ void betting_market_object::cancel_all_unmatched_bets(database& db) const
       db.cancel_bet(*old_book_itr, true);
    }
 
-   // then, cancel any delayed bets on that market.  We don't have an index for
-   // that, so walk through all delayed bets
-   book_itr = bet_odds_idx.begin();
-   while (book_itr != bet_odds_idx.end() &&
-          book_itr->end_of_delay)
-   {
-      auto old_book_itr = book_itr;
-      ++book_itr;
-      if (old_book_itr->betting_market_id == id)
-         db.cancel_bet(*old_book_itr, true);
-   }
+   // then, cancel any delayed bets on that market
+   flat_set<betting_market_id_type> markets;
+   markets.insert(id);
+   db.for_each_delayed_bet(markets, optional<time_point_sec>(), [&db](const bet_object& bet) {
+      db.cancel_bet(bet, true);
+   });
 }
     
 void betting_market_object::cancel_all_bets(database& db) const
@@ -464,6 +459,154 @@ void betting_market_object::on_canceled_event(database& db)
    my->state_machine.process_event(canceled_event(db));
 }
 
+bet_order_book_index::book_position bet_order_book_index::position_of( const object& obj )
+{
+   assert( dynamic_cast<const bet_object*>(&obj) ); // for debug only
+   const bet_object& bet = static_cast<const bet_object&>(obj);
+   book_position pos;
+   pos.betting_market_id = bet.betting_market_id;
+   pos.back_or_lay = bet.back_or_lay;
+   pos.backer_multiplier = bet.backer_multiplier;
+   pos.end_of_delay = bet.end_of_delay;
+   pos.bet_id = bet.id;
+   return pos;
+}
+
+void bet_order_book_index::refile_delays( betting_market_id_type betting_market_id, const optional<delay_key>& old_first,
+                                          const optional<delay_key>& new_first )
+{
+   // compare by hand, fc::optional's operator== treats any two set values as equal
+   if (!old_first && !new_first)
+      return;
+   if (old_first && new_first && *old_first == *new_first)
+      return;
+   if (old_first)
+      _markets_by_first_delay.erase(std::make_pair(*old_first, betting_market_id));
+   if (new_first)
+      _markets_by_first_delay.insert(std::make_pair(*new_first, betting_market_id));
+}
+
+void bet_order_book_index::add( const book_position& pos )
+{
+   market_book& book = _books[pos.betting_market_id];
+   if (pos.end_of_delay)
+   {
+      optional<delay_key> old_first;
+      if (!book.delayed_bets.empty())
+         old_first = *book.delayed_bets.begin();
+      book.delayed_bets.insert(std::make_pair(*pos.end_of_delay, pos.bet_id));
+      refile_delays(pos.betting_market_id, old_first, *book.delayed_bets.begin());
+   }
+   else if (pos.back_or_lay == bet_type::back)
+      book.back_levels[pos.backer_multiplier].insert(pos.bet_id);
+   else
+      book.lay_levels[pos.backer_multiplier].insert(pos.bet_id);
+}
+
+void bet_order_book_index::remove( const book_position& pos )
+{
+   auto book_iter = _books.find(pos.betting_market_id);
+   if (book_iter == _books.end())
+      return;
+   market_book& book = book_iter->second;
+   if (pos.end_of_delay)
+   {
+      optional<delay_key> old_first;
+      optional<delay_key> new_first;
+      if (!book.delayed_bets.empty())
+         old_first = *book.delayed_bets.begin();
+      book.delayed_bets.erase(std::make_pair(*pos.end_of_delay, pos.bet_id));
+      if (!book.delayed_bets.empty())
+         new_first = *book.delayed_bets.begin();
+      refile_delays(pos.betting_market_id, old_first, new_first);
+   }
+   else if (pos.back_or_lay == bet_type::back)
+   {
+      auto level = book.back_levels.find(pos.backer_multiplier);
+      if (level != book.back_levels.end() && level->second.erase(pos.bet_id) && level->second.empty())
+         book.back_levels.erase(level);
+   }
+   else
+   {
+      auto level = book.lay_levels.find(pos.backer_multiplier);
+      if (level != book.lay_levels.end() && level->second.erase(pos.bet_id) && level->second.empty())
+         book.lay_levels.erase(level);
+   }
+   if (book.empty())
+      _books.erase(book_iter);
+}
+
+void bet_order_book_index::object_inserted( const object& obj )
+{
+   add(position_of(obj));
+}
+
+void bet_order_book_index::object_restored( const object& obj )
+{
+   add(position_of(obj));
+}
+
+void bet_order_book_index::object_removed( const object& obj )
+{
+   remove(position_of(obj));
+}
+
+void bet_order_book_index::about_to_modify( const object& before )
+{
+   _before_modify = position_of(before);
+}
+
+void bet_order_book_index::object_modified( const object& after )
+{
+   // most modifications only change the amount, which leaves the bet where it is
+   book_position pos = position_of(after);
+   if (pos == _before_modify)
+      return;
+   remove(_before_modify);
+   add(pos);
+}
+
+optional<bet_id_type> bet_order_book_index::best_match( betting_market_id_type betting_market_id, bet_type type_to_match,
+                                                        bet_multiplier_type backer_multiplier )const
+{
+   auto book_iter = _books.find(betting_market_id);
+   if (book_iter == _books.end())
+      return optional<bet_id_type>();
+   const market_book& book = book_iter->second;
+   if (type_to_match == bet_type::back)
+   {
+      // a lay bet matches back bets offering the same or lower odds
+      auto level = book.back_levels.begin();
+      if (level != book.back_levels.end() && level->first <= backer_multiplier)
+         return *level->second.begin();
+   }
+   else
+   {
+      // a back bet matches lay bets offering the same or higher odds
+      auto level = book.lay_levels.begin();
+      if (level != book.lay_levels.end() && level->first >= backer_multiplier)
+         return *level->second.begin();
+   }
+   return optional<bet_id_type>();
+}
+
+optional<bet_order_book_index::delay_key> bet_order_book_index::first_delayed_bet( betting_market_id_type betting_market_id )const
+{
+   auto book_iter = _books.find(betting_market_id);
+   if (book_iter == _books.end() || book_iter->second.delayed_bets.empty())
+      return optional<delay_key>();
+   return *book_iter->second.delayed_bets.begin();
+}
+
+vector<betting_market_id_type> bet_order_book_index::markets_with_ended_delays( time_point_sec now )const
+{
+   vector<betting_market_id_type> markets;
+   for (auto iter = _markets_by_first_delay.begin();
+        iter != _markets_by_first_delay.end() && iter->first.first <= now; ++iter)
+      markets.push_back(iter->second);
+   return markets;
+}
+
 } } // graphene::chain
 
 namespace fc { 
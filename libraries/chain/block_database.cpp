@@ -24,7 +24,10 @@
 #include <graphene/chain/block_database.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 #include <fc/io/raw.hpp>
+#include <fc/interprocess/file_mapping.hpp>
 #include <fc/smart_ref_impl.hpp>
+#include <algorithm>
+#include <cstring>
 
 namespace graphene { namespace chain {
 
@@ -39,6 +42,34 @@ FC_REFLECT( graphene::chain::index_entry, (block_pos)(block_size)(block_id) );
 
 namespace graphene { namespace chain {
 
+block_view::block_view( std::shared_ptr<const fc::mapped_region> region, const char* data, uint32_t size,
+                        const block_id_type& id )
+:_region( std::move(region) ),_data(data),_size(size),_id(id)
+{
+}
+
+signed_block block_view::unpack()const
+{
+   FC_ASSERT( valid(), "Cannot unpack an empty block view" );
+   fc::datastream<const char*> ds( _data, _size );
+   signed_block result;
+   fc::raw::unpack( ds, result );
+   FC_ASSERT( result.id() == _id, "Stored block does not match its id", ("id", _id)("actual", result.id()) );
+   return result;
+}
+
+block_database::iterator::iterator( const block_database& db, uint32_t block_num )
+:_db(&db),_block_num(block_num)
+{
+   _view = _db->fetch_view_by_number( _block_num );
+}
+
+block_database::iterator& block_database::iterator::operator++()
+{
+   _view = _db->fetch_view_by_number( ++_block_num );
+   return *this;
+}
+
 void block_database::open( const fc::path& dbdir )
 { try {
    fc::create_directories(dbdir);
@@ -55,6 +86,13 @@ void block_database::open( const fc::path& dbdir )
      _block_num_to_pos.open( (dbdir/"index").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
      _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
    }
+
+   _index_map = mapped_file();
+   _index_map.path = dbdir/"index";
+   _blocks_map = mapped_file();
+   _blocks_map.path = dbdir/"blocks";
+   _index_size = fc::file_size( _index_map.path );
+   _blocks_size = fc::file_size( _blocks_map.path );
 } FC_CAPTURE_AND_RETHROW( (dbdir) ) }
 
 bool block_database::is_open()const
@@ -66,6 +104,11 @@ void block_database::close()
 {
   _blocks.close();
   _block_num_to_pos.close();
+  // views handed out earlier keep their own reference to the mapping
+  _blocks_map = mapped_file();
+  _index_map = mapped_file();
+  _blocks_size = 0;
+  _index_size = 0;
 }
 
 void block_database::flush()
@@ -74,6 +117,46 @@ void block_database::flush()
   _block_num_to_pos.flush();
 }
 
+const char* block_database::map_range( mapped_file& file, std::fstream& stream, uint64_t end )const
+{
+   if( end <= file.mapped_size )
+      return static_cast<const char*>( file.region->get_address() );
+
+   // the mapping is only ever extended to the current end of the file, so make sure
+   // everything written so far has reached it
+   stream.flush();
+   const uint64_t size = fc::file_size( file.path );
+   if( size < end )
+      return nullptr;
+
+   fc::file_mapping fm( file.path.generic_string().c_str(), fc::read_only );
+   file.region = std::make_shared<fc::mapped_region>( fm, fc::read_only, 0, size );
+   file.mapped_size = size;
+   return static_cast<const char*>( file.region->get_address() );
+}
+
+bool block_database::read_index_entry( uint32_t block_num, index_entry& e )const
+{
+   const uint64_t index_pos = uint64_t(block_num) * sizeof(index_entry);
+   if( index_pos + sizeof(index_entry) > _index_size )
+      return false;
+   const char* base = map_range( _index_map, _block_num_to_pos, index_pos + sizeof(index_entry) );
+   if( base == nullptr )
+      return false;
+   memcpy( (char*)&e, base + index_pos, sizeof(e) );
+   return true;
+}
+
+block_view block_database::view_of( const index_entry& e )const
+{
+   if( e.block_size == 0 || e.block_pos + e.block_size > _blocks_size )
+      return block_view();
+   const char* base = map_range( _blocks_map, _blocks, e.block_pos + e.block_size );
+   if( base == nullptr )
+      return block_view();
+   return block_view( _blocks_map.region, base + e.block_pos, e.block_size, e.block_id );
+}
+
 void block_database::store( const block_id_type& _id, const signed_block& b )
 {
    block_id_type id = _id;
@@ -83,33 +166,34 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
       elog( "id argument of block_database::store() was not initialized for block ${id}", ("id", id) );
    }
    auto num = block_header::num_from_id(id);
-   _block_num_to_pos.seekp( sizeof( index_entry ) * num );
-   index_entry e;
-   _blocks.seekp( 0, _blocks.end );
    auto vec = fc::raw::pack( b );
-   e.block_pos  = _blocks.tellp();
+   index_entry e;
+   e.block_pos  = _blocks_size;
    e.block_size = vec.size();
    e.block_id   = id;
+   _blocks.seekp( _blocks_size );
    _blocks.write( vec.data(), vec.size() );
+   _blocks_size += vec.size();
+
+   // index entries may overwrite bytes that are already mapped, so they are flushed right away
+   _block_num_to_pos.seekp( sizeof( index_entry ) * num );
    _block_num_to_pos.write( (char*)&e, sizeof(e) );
+   _block_num_to_pos.flush();
+   _index_size = std::max<uint64_t>( _index_size, sizeof( index_entry ) * (uint64_t(num) + 1) );
 }
 
 void block_database::remove( const block_id_type& id )
 { try {
    index_entry e;
-   auto index_pos = sizeof(e)*block_header::num_from_id(id);
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   if( !read_index_entry( block_header::num_from_id(id), e ) )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block ${id} not contained in block database", ("id", id));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
    if( e.block_id == id )
    {
       e.block_size = 0;
       _block_num_to_pos.seekp( sizeof(e)*block_header::num_from_id(id) );
       _block_num_to_pos.write( (char*)&e, sizeof(e) );
+      _block_num_to_pos.flush();
    }
 } FC_CAPTURE_AND_RETHROW( (id) ) }
 
@@ -119,12 +203,8 @@ bool block_database::contains( const block_id_type& id )const
       return false;
 
    index_entry e;
-   auto index_pos = sizeof(e)*block_header::num_from_id(id);
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   if( !read_index_entry( block_header::num_from_id(id), e ) )
       return false;
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
 
    return e.block_id == id && e.block_size > 0;
 }
@@ -133,40 +213,41 @@ block_id_type block_database::fetch_block_id( uint32_t block_num )const
 {
    assert( block_num != 0 );
    index_entry e;
-   auto index_pos = sizeof(e)*block_num;
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= int64_t(index_pos) )
+   if( !read_index_entry( block_num, e ) )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block number ${block_num} not contained in block database", ("block_num", block_num));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
    FC_ASSERT( e.block_id != block_id_type(), "Empty block_id in block_database (maybe corrupt on disk?)" );
    return e.block_id;
 }
 
+block_view block_database::fetch_view( const block_id_type& id )const
+{
+   index_entry e;
+   if( id == block_id_type() || !read_index_entry( block_header::num_from_id(id), e ) || e.block_id != id )
+      return block_view();
+   return view_of( e );
+}
+
+block_view block_database::fetch_view_by_number( uint32_t block_num )const
+{
+   index_entry e;
+   if( !read_index_entry( block_num, e ) || e.block_id == block_id_type() )
+      return block_view();
+   return view_of( e );
+}
+
+block_database::iterator block_database::begin( uint32_t first_block_num )const
+{
+   return iterator( *this, first_block_num );
+}
+
 optional<signed_block> block_database::fetch_optional( const block_id_type& id )const
 {
    try
    {
-      index_entry e;
-      auto index_pos = sizeof(e)*block_header::num_from_id(id);
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
-         return {};
-
-      _block_num_to_pos.seekg( index_pos );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-      if( e.block_id != id ) return optional<signed_block>();
-
-      vector<char> data( e.block_size );
-      _blocks.seekg( e.block_pos );
-      if (e.block_size)
-         _blocks.read( data.data(), e.block_size );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
-      return result;
+      block_view view = fetch_view( id );
+      if( view.valid() )
+         return view.unpack();
    }
    catch (const fc::exception&)
    {
@@ -181,21 +262,9 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
 {
    try
    {
-      index_entry e;
-      auto index_pos = sizeof(e)*block_num;
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
-         return {};
-
-      _block_num_to_pos.seekg( index_pos, _block_num_to_pos.beg );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-      vector<char> data( e.block_size );
-      _blocks.seekg( e.block_pos );
-      _blocks.read( data.data(), e.block_size );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
-      return result;
+      block_view view = fetch_view_by_number( block_num );
+      if( view.valid() )
+         return view.unpack();
    }
    catch (const fc::exception&)
    {
@@ -206,34 +275,31 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
    return optional<signed_block>();
 }
 
+optional<uint32_t> block_database::last_stored_num()const
+{
+   if( _index_size < sizeof(index_entry) )
+      return optional<uint32_t>();
+
+   uint32_t num = _index_size / sizeof(index_entry) - 1;
+   index_entry e;
+   while( read_index_entry( num, e ) )
+   {
+      if( e.block_size > 0 )
+         return num;
+      if( num == 0 )
+         break;
+      --num;
+   }
+   return optional<uint32_t>();
+}
+
 optional<signed_block> block_database::last()const
 {
    try
    {
-      index_entry e;
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-
-      if( _block_num_to_pos.tellp() < sizeof(index_entry) )
-         return optional<signed_block>();
-
-      _block_num_to_pos.seekg( -sizeof(index_entry), _block_num_to_pos.end );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-      uint64_t pos = _block_num_to_pos.tellg();
-      while( e.block_size == 0 && pos > 0 )
-      {
-         pos -= sizeof(index_entry);
-         _block_num_to_pos.seekg( pos );
-         _block_num_to_pos.read( (char*)&e, sizeof(e) );
-      }
-
-      if( e.block_size == 0 )
-         return optional<signed_block>();
-
-      vector<char> data( e.block_size );
-      _blocks.seekg( e.block_pos );
-      _blocks.read( data.data(), e.block_size );
-      auto result = fc::raw::unpack<signed_block>(data);
-      return result;
+      optional<uint32_t> num = last_stored_num();
+      if( num.valid() )
+         return fetch_view_by_number( *num ).unpack();
    }
    catch (const fc::exception&)
    {
@@ -248,26 +314,10 @@ optional<block_id_type> block_database::last_id()const
 {
    try
    {
+      optional<uint32_t> num = last_stored_num();
       index_entry e;
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-
-      if( _block_num_to_pos.tellp() < sizeof(index_entry) )
-         return optional<block_id_type>();
-
-      _block_num_to_pos.seekg( -sizeof(index_entry), _block_num_to_pos.end );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-      uint64_t pos = _block_num_to_pos.tellg();
-      while( e.block_size == 0 && pos > 0 )
-      {
-         pos -= sizeof(index_entry);
-         _block_num_to_pos.seekg( pos );
-         _block_num_to_pos.read( (char*)&e, sizeof(e) );
-      }
-
-      if( e.block_size == 0 )
-         return optional<block_id_type>();
-
-      return e.block_id;
+      if( num.valid() && read_index_entry( *num, e ) )
+         return e.block_id;
    }
    catch (const fc::exception&)
    {
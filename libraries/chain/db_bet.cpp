@@ -28,6 +28,7 @@
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/betting_market_object.hpp>
 #include <graphene/chain/event_object.hpp>
+#include <graphene/utilities/thread_pool.hpp>
 
 #include <boost/range/iterator_range.hpp>
 #include <boost/range/combine.hpp>
@@ -65,17 +66,12 @@ void database::cancel_all_unmatched_bets_on_betting_market(const betting_market_
       cancel_bet(*old_book_itr, true);
    }
 
-   // then, cancel any delayed bets on that market.  We don't have an index for
-   // that, so walk through all delayed bets
-   book_itr = bet_odds_idx.begin();
-   while (book_itr != bet_odds_idx.end() &&
-          book_itr->end_of_delay)
-   {
-      auto old_book_itr = book_itr;
-      ++book_itr;
-      if (old_book_itr->betting_market_id == betting_market.id)
-         cancel_bet(*old_book_itr, true);
-   }
+   // then, cancel any delayed bets on that market
+   flat_set<betting_market_id_type> markets;
+   markets.insert(betting_market.id);
+   for_each_delayed_bet(markets, optional<time_point_sec>(), [this](const bet_object& bet) {
+      cancel_bet(bet, true);
+   });
 }
 
 void database::validate_betting_market_group_resolutions(const betting_market_group_object& betting_market_group,
@@ -110,6 +106,36 @@ void database::validate_betting_market_group_resolutions(const betting_market_gr
       FC_ASSERT(number_of_wins == 1, "There must be exactly one winning market");
 }
 
+void database::for_each_delayed_bet(const flat_set<betting_market_id_type>& markets, optional<time_point_sec> ended_by,
+                                   const std::function<void(const bet_object&)>& f)
+{
+   typedef bet_order_book_index::delay_key delay_key;
+
+   // merge the delayed bets of each market, which gives the same order the by_odds index
+   // keeps delayed bets in across all markets
+   std::set<std::pair<delay_key, betting_market_id_type> > next_bets;
+   for (const betting_market_id_type& betting_market_id : markets)
+   {
+      optional<delay_key> first = _bet_order_book->first_delayed_bet(betting_market_id);
+      if (first)
+         next_bets.insert(std::make_pair(*first, betting_market_id));
+   }
+
+   while (!next_bets.empty() && (!ended_by || next_bets.begin()->first.first <= *ended_by))
+   {
+      const bet_id_type bet_id = next_bets.begin()->first.second;
+      const betting_market_id_type betting_market_id = next_bets.begin()->second;
+      next_bets.erase(next_bets.begin());
+
+      f(bet_id(*this));
+
+      optional<delay_key> next = _bet_order_book->first_delayed_bet(betting_market_id);
+      FC_ASSERT(!next || next->second != bet_id, "delayed bet ${bet_id} was left delayed", ("bet_id", bet_id));
+      if (next)
+         next_bets.insert(std::make_pair(*next, betting_market_id));
+   }
+}
+
 void database::cancel_all_unmatched_bets_on_betting_market_group(const betting_market_group_object& betting_market_group)
 {
    auto& betting_market_index = get_index_type<betting_market_object_index>().indices().get<by_betting_market_group_id>();
@@ -203,16 +229,34 @@ void database::settle_betting_market_group(const betting_market_group_object& be
       }
    }
 
-   // walking through bettors' positions and collecting winings and fees respecting asset_id
+   // Settling is done in two steps.  Working out what each bettor is owed only reads their positions,
+   // so it is done for all bettors in parallel.  The results are then applied serially, in bettor order,
+   // so the resulting state and virtual operations do not depend on the number of threads.
+   struct bettor_settlement
+   {
+      account_id_type bettor_id;
+      const std::vector<const betting_market_position_object*>* positions = nullptr;
+      std::vector<const betting_market_position_object*> settled_positions;
+      share_type payout_amounts;
+      share_type rake_amount;
+   };
+   std::vector<bettor_settlement> settlements;
+   settlements.reserve(bettor_positions_map.size());
    for (const auto& bettor_positions_pair: bettor_positions_map)
    {
-      uint16_t rake_fee_percentage = get_global_properties().parameters.betting_rake_fee_percentage();
+      settlements.emplace_back();
+      settlements.back().bettor_id = bettor_positions_pair.first;
+      settlements.back().positions = &bettor_positions_pair.second;
+   }
+
+   const uint16_t rake_fee_percentage = get_global_properties().parameters.betting_rake_fee_percentage();
+
+   // walking through bettors' positions and collecting winings and fees respecting asset_id
+   auto compute_settlement = [&](size_t i) {
+      bettor_settlement& settlement = settlements[i];
       share_type net_profits;
-      share_type payout_amounts;
-      account_id_type bettor_id = bettor_positions_pair.first;
-      const std::vector<const betting_market_position_object*>& bettor_positions = bettor_positions_pair.second;
 
-      for (const betting_market_position_object* position : bettor_positions)
+      for (const betting_market_position_object* position : *settlement.positions)
       {
          betting_market_resolution_type resolution;
          try
@@ -224,65 +268,65 @@ void database::settle_betting_market_group(const betting_market_group_object& be
             FC_THROW_EXCEPTION(fc::key_not_found_exception, "Unexpected betting market ID, shouldn't happen");
          }
 
-         ///if (cancel)
-         ///   resolution = betting_market_resolution_type::cancel;
-         ///else
-         ///{
-         ///   // checked in evaluator, should never happen, see above
-         ///   assert(resolutions.count(position->betting_market_id));
-         ///   resolution = resolutions.at(position->betting_market_id);
-         ///}
-
-
          switch (resolution)
          {
             case betting_market_resolution_type::win:
                {
                   share_type total_payout = position->pay_if_payout_condition + position->pay_if_not_canceled;
-                  payout_amounts += total_payout;
+                  settlement.payout_amounts += total_payout;
                   net_profits += total_payout - position->pay_if_canceled;
                   break;
                }
             case betting_market_resolution_type::not_win:
                {
                   share_type total_payout = position->pay_if_not_payout_condition + position->pay_if_not_canceled;
-                  payout_amounts += total_payout;
+                  settlement.payout_amounts += total_payout;
                   net_profits += total_payout - position->pay_if_canceled;
                   break;
                }
             case betting_market_resolution_type::cancel:
-               payout_amounts += position->pay_if_canceled;
+               settlement.payout_amounts += position->pay_if_canceled;
                break;
             default:
                continue;
          }
-         remove(*position);
+         settlement.settled_positions.push_back(position);
       }
 
-      // pay the fees to the dividend-distribution account if net profit
-      share_type rake_amount;
+      // the fees go to the dividend-distribution account if net profit
       if (net_profits.value > 0 && rake_account_id)
+         settlement.rake_amount = ((fc::uint128_t(net_profits.value) * rake_fee_percentage + GRAPHENE_100_PERCENT - 1) / GRAPHENE_100_PERCENT).to_uint64();
+   };
+   if (_settlement_pool)
+      _settlement_pool->for_each_index_blocking(settlements.size(), compute_settlement);
+   else
+      for (size_t i = 0; i < settlements.size(); ++i)
+         compute_settlement(i);
+
+   share_type total_rake_to_account;
+   for (const bettor_settlement& settlement : settlements)
+   {
+      for (const betting_market_position_object* position : settlement.settled_positions)
+         remove(*position);
+
+      if (settlement.rake_amount.value)
       {
-         rake_amount = ((fc::uint128_t(net_profits.value) * rake_fee_percentage + GRAPHENE_100_PERCENT - 1) / GRAPHENE_100_PERCENT).to_uint64();
-         share_type affiliates_share;
-         if (rake_amount.value)
-            affiliates_share = payout_helper.payout( bettor_id, rake_amount );
-         FC_ASSERT( rake_amount.value >= affiliates_share.value );
-         if (rake_amount.value > affiliates_share.value)
-            adjust_balance(*rake_account_id, asset(rake_amount - affiliates_share, betting_market_group.asset_id));
+         share_type affiliates_share = payout_helper.payout( settlement.bettor_id, settlement.rake_amount );
+         FC_ASSERT( settlement.rake_amount.value >= affiliates_share.value );
+         total_rake_to_account += settlement.rake_amount - affiliates_share;
       }
-      
+
       // pay winning - rake
-      adjust_balance(bettor_id, asset(payout_amounts - rake_amount, betting_market_group.asset_id));
-      // [ROL]
-      //fc_idump(fc::logger::get("betting"), (payout_amounts)(net_profits.value)(rake_amount.value));
+      adjust_balance(settlement.bettor_id, asset(settlement.payout_amounts - settlement.rake_amount, betting_market_group.asset_id));
 
-      push_applied_operation(betting_market_group_resolved_operation(bettor_id,
+      push_applied_operation(betting_market_group_resolved_operation(settlement.bettor_id,
                              betting_market_group.id,
                              resolutions_by_market_id,
-                             payout_amounts,
-                             rake_amount));
+                             settlement.payout_amounts,
+                             settlement.rake_amount));
    }
+   if (total_rake_to_account.value)
+      adjust_balance(*rake_account_id, asset(total_rake_to_account, betting_market_group.asset_id));
 
    // At this point, the betting market group will either be in the "graded" or "canceled" state,
    // if it was graded, mark it as settled.  if it's canceled, let it remain canceled.
@@ -311,6 +355,18 @@ void database::settle_betting_market_group(const betting_market_group_object& be
    payout_helper.commit();
 }
 
+void database::set_settlement_threads( uint32_t thread_count )
+{
+   _settlement_pool.reset();
+   if( thread_count > 0 )
+      _settlement_pool.reset( new graphene::utilities::thread_pool( "settlement", thread_count ) );
+}
+
+uint32_t database::get_settlement_threads()const
+{
+   return _settlement_pool ? _settlement_pool->size() : 0;
+}
+
 void database::remove_completed_events()
 {
    const auto& event_index = get_index_type<event_object_index>().indices().get<by_event_status>();
@@ -376,16 +432,21 @@ share_type adjust_betting_position(database& db,
 } FC_CAPTURE_AND_RETHROW((bettor_id)(betting_market_id)(bet_amount)) }
 
 
-// called twice when a bet is matched, once for the taker, once for the maker
+// called twice when a bet is matched, once for the taker, once for the maker.
+// If deferred_credit is given, winnings are added to it instead of being paid out right away.
 bool bet_was_matched(database& db, const bet_object& bet, 
                      share_type amount_bet, share_type amount_matched, 
                      bet_multiplier_type actual_multiplier,
-                     bool refund_unmatched_portion)
+                     bool refund_unmatched_portion,
+                     share_type* deferred_credit = nullptr)
 {
    // record their bet, modifying their position, and return any winnings
    share_type guaranteed_winnings_returned = adjust_betting_position(db, bet.bettor_id, bet.betting_market_id, 
                                                                      bet.back_or_lay, amount_bet, amount_matched);
-   db.adjust_balance(bet.bettor_id, asset(guaranteed_winnings_returned, bet.amount_to_bet.asset_id));
+   if (deferred_credit)
+      *deferred_credit += guaranteed_winnings_returned;
+   else
+      db.adjust_balance(bet.bettor_id, asset(guaranteed_winnings_returned, bet.amount_to_bet.asset_id));
 
    // generate a virtual "match" op
    asset asset_amount_bet(amount_bet, bet.amount_to_bet.asset_id);
@@ -422,6 +483,9 @@ bool bet_was_matched(database& db, const bet_object& bet,
 /**
  *  Matches the two orders,
  *
+ *  Refunds and winnings owed to the taker are added to taker_credit; the caller pays them out once
+ *  it is done matching the taker bet.
+ *
  *  @return a bit field indicating which orders were filled (and thus removed)
  *
  *  0 - no bet was matched (this will never happen)
@@ -429,7 +493,7 @@ bool bet_was_matched(database& db, const bet_object& bet,
  *  2 - maker_bet was filled and removed from the books
  *  3 - both were filled and removed from the books
  */
-int match_bet(database& db, const bet_object& taker_bet, const bet_object& maker_bet )
+int match_bet(database& db, const bet_object& taker_bet, const bet_object& maker_bet, share_type& taker_credit )
 {
    //fc_idump(fc::logger::get("betting"), (taker_bet)(maker_bet));
    assert(taker_bet.amount_to_bet.asset_id == maker_bet.amount_to_bet.asset_id);
@@ -556,7 +620,7 @@ int match_bet(database& db, const bet_object& taker_bet, const bet_object& maker
                  ("taker_odds", taker_bet.backer_multiplier));
          fc_ddump(fc::logger::get("betting"), (taker_bet));
 
-         db.adjust_balance(taker_bet.bettor_id, asset(taker_refund_amount, taker_bet.amount_to_bet.asset_id));
+         taker_credit += taker_refund_amount;
          // TODO: update global statistics
          bet_adjusted_operation bet_adjusted_op(taker_bet.bettor_id, taker_bet.id, 
                                                 asset(taker_refund_amount, taker_bet.amount_to_bet.asset_id));
@@ -567,7 +631,7 @@ int match_bet(database& db, const bet_object& taker_bet, const bet_object& maker
 
    // if the maker bet stays on the books, we need to make sure the taker bet is removed from the books (either it fills completely,
    // or any un-filled amount is canceled)
-   result |= bet_was_matched(db, taker_bet, taker_amount_to_match, maker_amount_to_match, maker_bet.backer_multiplier, !maker_bet_will_completely_match);
+   result |= bet_was_matched(db, taker_bet, taker_amount_to_match, maker_amount_to_match, maker_bet.backer_multiplier, !maker_bet_will_completely_match, &taker_credit);
    result |= bet_was_matched(db, maker_bet, maker_amount_to_match, taker_amount_to_match, maker_bet.backer_multiplier, false) << 1;
 
    assert(result != 0);
@@ -611,30 +675,31 @@ bool database::place_bet(const bet_object& new_bet_object)
            ("new_bet", new_bet_object));
    }
 
-   const auto& bet_odds_idx = get_index_type<bet_object_index>().indices().get<by_odds>();
-
-   bet_type bet_type_to_match = new_bet_object.back_or_lay == bet_type::back ? bet_type::lay : bet_type::back;
-   auto book_itr = bet_odds_idx.lower_bound(std::make_tuple(new_bet_object.betting_market_id, bet_type_to_match));
-   auto book_end = bet_odds_idx.upper_bound(std::make_tuple(new_bet_object.betting_market_id, bet_type_to_match, new_bet_object.backer_multiplier));
-
-   // fc_ilog(fc::logger::get("betting"), "");
-   // fc_ilog(fc::logger::get("betting"), "------------  order book ------------------");
-   // for (auto itr = book_itr; itr != book_end; ++itr)
-   //    fc_idump(fc::logger::get("betting"), (*itr));
-   // fc_ilog(fc::logger::get("betting"), "------------  order book ------------------");
+   // The maker is always the oldest bet at the best price level that crosses the taker's odds.  We only go on
+   // to the next maker once this one was consumed, so the book is simply asked for its best match again.
+   const bet_type bet_type_to_match = new_bet_object.back_or_lay == bet_type::back ? bet_type::lay : bet_type::back;
+   const betting_market_id_type betting_market_id = new_bet_object.betting_market_id;
+   const bet_multiplier_type backer_multiplier = new_bet_object.backer_multiplier;
+   const account_id_type bettor_id = new_bet_object.bettor_id;
+   const asset_id_type bet_asset_id = new_bet_object.amount_to_bet.asset_id;
 
+   // refunds and winnings owed to the taker are paid once, after matching
+   share_type taker_credit;
    int orders_matched_flags = 0;
    bool finished = false;
-   while (!finished && book_itr != book_end)
+   while (!finished)
    {
-      auto old_book_itr = book_itr;
-      ++book_itr;
+      optional<bet_id_type> maker_bet_id = _bet_order_book->best_match(betting_market_id, bet_type_to_match, backer_multiplier);
+      if (!maker_bet_id)
+         break;
 
-      orders_matched_flags = match_bet(*this, new_bet_object, *old_book_itr);
+      orders_matched_flags = match_bet(*this, new_bet_object, (*maker_bet_id)(*this), taker_credit);
 
       // we continue if the maker bet was completely consumed AND the taker bet was not
       finished = orders_matched_flags != 2;
    }
+   adjust_balance(bettor_id, asset(taker_credit, bet_asset_id));
+
    if (!(orders_matched_flags & 1))
       fc_ddump(fc::logger::get("betting"), (new_bet_object));
 
@@ -39,50 +39,10 @@
 #include <graphene/chain/protocol/fee_schedule.hpp>
 #include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/evaluator.hpp>
-#include <fc/crypto/digest.hpp>
+#include <graphene/utilities/thread_pool.hpp>
 
 #include <fc/smart_ref_impl.hpp>
 
-namespace {
-    
-   struct proposed_operations_digest_accumulator
-   {
-      typedef void result_type;
-      
-      void operator()(const graphene::chain::proposal_create_operation& proposal)
-      {
-         for (auto& operation: proposal.proposed_ops)
-         {
-            proposed_operations_digests.push_back(fc::digest(operation.op));
-         }
-      }
-       
-      //empty template method is needed for all other operation types
-      //we can ignore them, we are interested in only proposal_create_operation
-      template<class T>
-      void operator()(const T&) 
-      {}
-      
-      std::vector<fc::sha256> proposed_operations_digests;
-   };
-   
-   std::vector<fc::sha256> gather_proposed_operations_digests(const graphene::chain::transaction& trx)
-   {
-      proposed_operations_digest_accumulator digest_accumulator;
-      
-      for (auto& operation: trx.operations)
-      {
-         if( operation.which() != graphene::chain::operation::tag<graphene::chain::betting_market_group_create_operation>::value
-          && operation.which() != graphene::chain::operation::tag<graphene::chain::betting_market_create_operation>::value )
-            operation.visit(digest_accumulator);
-         else
-            edump( ("Found dup"));
-      }
-       
-      return digest_accumulator.proposed_operations_digests;
-   }
-}
-
 namespace graphene { namespace chain {
 
 bool database::is_known_block( const block_id_type& id )const
@@ -113,6 +73,16 @@ optional<signed_block> database::fetch_block_by_id( const block_id_type& id )con
    return b->data;
 }
 
+block_view database::fetch_block_view_by_id( const block_id_type& id )const
+{
+   return _block_id_to_block.fetch_view( id );
+}
+
+block_view database::fetch_block_view_by_number( uint32_t num )const
+{
+   return _block_id_to_block.fetch_view_by_number( num );
+}
+
 optional<signed_block> database::fetch_block_by_number( uint32_t num )const
 {
    auto results = _fork_db.fetch_block_by_number(num);
@@ -151,25 +121,13 @@ std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of
     
 void database::check_tansaction_for_duplicated_operations(const signed_transaction& trx)
 {
-   const auto& proposal_index = get_index<proposal_object>();
-   std::set<fc::sha256> existed_operations_digests;
-   
-   proposal_index.inspect_all_objects( [&](const object& obj){
-      const proposal_object& proposal = static_cast<const proposal_object&>(obj);
-      auto proposed_operations_digests = gather_proposed_operations_digests( proposal.proposed_transaction );
-      existed_operations_digests.insert( proposed_operations_digests.begin(), proposed_operations_digests.end() );
-   });
-   
-   for (auto& pending_transaction: _pending_tx)
-   {
-      auto proposed_operations_digests = gather_proposed_operations_digests(pending_transaction);
-      existed_operations_digests.insert(proposed_operations_digests.begin(), proposed_operations_digests.end());
-   }
-    
+   const auto& proposed_digests = _proposed_operations_digests->digests();
+
    auto proposed_operations_digests = gather_proposed_operations_digests(trx);
    for (auto& digest: proposed_operations_digests)
    {
-      FC_ASSERT(existed_operations_digests.count(digest) == 0, "Proposed operation is already pending for approval.");
+      FC_ASSERT(!proposed_digests.contains(digest) && !_pending_tx_digests.contains(digest),
+                "Proposed operation is already pending for approval.");
    }
 }
 
@@ -182,6 +140,8 @@ void database::check_tansaction_for_duplicated_operations(const signed_transacti
 bool database::push_block(const signed_block& new_block, uint32_t skip)
 {
 //   idump((new_block.block_num())(new_block.id())(new_block.timestamp)(new_block.previous));
+   precompute_signature_keys( new_block, skip );
+
    bool result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -194,6 +154,69 @@ bool database::push_block(const signed_block& new_block, uint32_t skip)
    return result;
 }
 
+void database::precompute_signature_keys( const signed_block& b, uint32_t skip )
+{ try {
+   if( !_signature_recovery_pool || (skip & (skip_transaction_signatures | skip_authority_check)) )
+      return;
+
+   const chain_id_type& chain_id = get_chain_id();
+   const size_t count = b.transactions.size();
+   vector<digest_type> digests( count );
+   vector<optional<flat_set<public_key_type>>> keys( count );
+
+   _signature_recovery_pool->for_each_index( count, [&]( size_t i ) {
+      const signed_transaction& trx = b.transactions[i];
+      digests[i] = trx.sig_digest( chain_id );
+   });
+
+   vector<size_t> to_recover;
+   to_recover.reserve( count );
+   for( size_t i = 0; i < count; ++i )
+      if( !_signature_key_cache.contains( digests[i], b.transactions[i].signatures ) )
+         to_recover.push_back( i );
+
+   _signature_recovery_pool->for_each_index( to_recover.size(), [&]( size_t n ) {
+      const size_t i = to_recover[n];
+      const signed_transaction& trx = b.transactions[i];
+      try {
+         flat_set<public_key_type> result;
+         for( const auto& sig : trx.signatures )
+            if( !result.insert( fc::ecc::public_key( sig, digests[i] ) ).second )
+               return; // duplicate signature, leave it to the serial check to reject the transaction
+         keys[i] = std::move( result );
+      } catch( const fc::exception& ) {
+         // unrecoverable signature, the serial check will report it
+      }
+   });
+
+   for( size_t i : to_recover )
+      if( keys[i] )
+         _signature_key_cache.insert( digests[i], b.transactions[i].signatures, std::move( *keys[i] ) );
+} FC_CAPTURE_AND_RETHROW( (b.block_num()) ) }
+
+flat_set<public_key_type> database::get_signature_keys( const signed_transaction& trx )
+{
+   digest_type sig_digest = trx.sig_digest( get_chain_id() );
+   const flat_set<public_key_type>* cached = _signature_key_cache.find( sig_digest, trx.signatures );
+   if( cached != nullptr )
+      return *cached;
+   flat_set<public_key_type> result = trx.get_signature_keys( get_chain_id() );
+   _signature_key_cache.insert( sig_digest, trx.signatures, result );
+   return result;
+}
+
+void database::set_signature_recovery_threads( uint32_t thread_count )
+{
+   _signature_recovery_pool.reset();
+   if( thread_count > 0 )
+      _signature_recovery_pool.reset( new graphene::utilities::thread_pool( "sigrecover", thread_count ) );
+}
+
+uint32_t database::get_signature_recovery_threads()const
+{
+   return _signature_recovery_pool ? _signature_recovery_pool->size() : 0;
+}
+
 bool database::_push_block(const signed_block& new_block)
 { try {
    uint32_t skip = get_node_properties().skip_flags;
@@ -227,6 +250,8 @@ bool database::_push_block(const signed_block& new_block)
                    apply_block( (*ritr)->data, skip );
                    _block_id_to_block.store( (*ritr)->id, (*ritr)->data );
                    session.commit();
+                   // a checkpoint block may be anywhere on the new fork, not only at its head
+                   update_state_checkpoint();
                 }
                 catch ( const fc::exception& e ) { except = e; }
                 if( except )
@@ -272,6 +297,9 @@ bool database::_push_block(const signed_block& new_block)
       throw;
    }
 
+   if( !(skip&skip_fork_db) )
+      update_state_checkpoint();
+
    return false;
 } FC_CAPTURE_AND_RETHROW( (new_block) ) }
 
@@ -309,6 +337,7 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
    auto temp_session = _undo_db.start_undo_session();
    auto processed_trx = _apply_transaction( trx );
    _pending_tx.push_back(processed_trx);
+   _pending_tx_digests.add(processed_trx);
 
    // notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
@@ -518,6 +547,7 @@ void database::clear_pending()
 { try {
    assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
    _pending_tx.clear();
+   _pending_tx_digests.clear();
    _pending_tx_session.reset();
 } FC_CAPTURE_AND_RETHROW() }
 
@@ -671,7 +701,11 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    {
       auto get_active = [&]( account_id_type id ) { return &id(*this).active; };
       auto get_owner  = [&]( account_id_type id ) { return &id(*this).owner;  };
-      trx.verify_authority( chain_id, get_active, get_owner, get_global_properties().parameters.max_authority_depth );
+      // keeps the transaction in the error context, as signed_transaction::verify_authority() does
+      try {
+         graphene::chain::verify_authority( trx.operations, get_signature_keys( trx ), get_active, get_owner,
+                                            get_global_properties().parameters.max_authority_depth );
+      } FC_CAPTURE_AND_RETHROW( (trx) )
    }
 
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
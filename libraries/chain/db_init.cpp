@@ -259,6 +259,7 @@ void database::initialize_indexes()
 
    auto prop_index = add_index< primary_index<proposal_index > >();
    prop_index->add_secondary_index<required_approval_index>();
+   _proposed_operations_digests = prop_index->add_secondary_index<proposed_operations_digest_index>();
 
    add_index< primary_index<withdraw_permission_index > >();
    add_index< primary_index<vesting_balance_index> >();
@@ -271,17 +272,20 @@ void database::initialize_indexes()
    add_index< primary_index<betting_market_rules_object_index > >();
    add_index< primary_index<betting_market_group_object_index > >();
    add_index< primary_index<betting_market_object_index > >();
-   add_index< primary_index<bet_object_index > >();
+   auto bet_idx = add_index< primary_index<bet_object_index > >();
+   _bet_order_book = bet_idx->add_secondary_index<bet_order_book_index>();
 
    add_index< primary_index<tournament_index> >();
    auto tournament_details_idx = add_index< primary_index<tournament_details_index> >();
    tournament_details_idx->add_secondary_index<tournament_players_index>();
-   add_index< primary_index<match_index> >();
+   auto match_idx = add_index< primary_index<match_index> >();
+   _match_activity = match_idx->add_secondary_index<match_activity_index>();
    add_index< primary_index<game_index> >();
 
    //Implementation object indexes
    add_index< primary_index<transaction_index                             > >();
-   add_index< primary_index<account_balance_index                         > >();
+   auto balance_idx = add_index< primary_index<account_balance_index> >();
+   balance_idx->add_secondary_index<asset_holders_count_index>();
    add_index< primary_index<asset_bitasset_data_index                     > >();
    add_index< primary_index<asset_dividend_data_object_index              > >();
    add_index< primary_index<simple_index<global_property_object          >> >();
@@ -27,14 +27,68 @@
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 
+#include <graphene/utilities/thread_pool.hpp>
+
 #include <fc/io/fstream.hpp>
 
+#include <deque>
 #include <fstream>
 #include <functional>
 #include <iostream>
 
 namespace graphene { namespace chain {
 
+namespace {
+
+   /// a block read back from the block log, deserialized and hashed ahead of being applied
+   struct prepared_block
+   {
+      optional<signed_block> block;
+      bool                   merkle_root_matches = false;
+   };
+
+   struct prepared_batch
+   {
+      vector<prepared_block> blocks;
+      fc::microseconds       elapsed;
+   };
+
+   /// runs on the reindex worker threads; must not touch the database
+   std::shared_ptr<prepared_batch> prepare_blocks( const vector<block_view>& views )
+   {
+      auto start = fc::time_point::now();
+      std::shared_ptr<prepared_batch> batch = std::make_shared<prepared_batch>();
+      prepared_batch& result = *batch;
+      result.blocks.resize( views.size() );
+      for( size_t i = 0; i < views.size(); ++i )
+      {
+         if( !views[i].valid() )
+            continue;
+         try
+         {
+            prepared_block& p = result.blocks[i];
+            p.block = views[i].unpack();
+            // id and digest are memoized on the block and travel with it to the main thread
+            p.block->digest();
+            p.merkle_root_matches = ( p.block->transaction_merkle_root == p.block->calculate_merkle_root() );
+         }
+         catch( const fc::exception& e )
+         {
+            wlog( "Unable to read block ${n} from the block log: ${e}", ("n", views[i].block_num())("e", e.to_detail_string()) );
+            result.blocks[i].block.reset();
+         }
+         catch( const std::exception& e )
+         {
+            wlog( "Unable to read block ${n} from the block log: ${e}", ("n", views[i].block_num())("e", e.what()) );
+            result.blocks[i].block.reset();
+         }
+      }
+      result.elapsed = fc::time_point::now() - start;
+      return batch;
+   }
+
+} // anonymous namespace
+
 database::database() :
    _random_number_generator(fc::ripemd160().data())
 {
@@ -64,57 +118,158 @@ void database::reindex(fc::path data_dir, const genesis_state_type& initial_allo
    const auto last_block_num = last_block->block_num();
 
    ilog( "Replaying blocks..." );
-   // Right now, we leave undo_db enabled when replaying when the bookie plugin is 
-   // enabled.  It depends on new/changed/removed object notifications, and those are 
-   // only fired when the undo_db is enabled
+   replay_blocks( 1, last_block_num );
+   auto end = fc::time_point::now();
+   ilog( "Done reindexing, elapsed time: ${t} sec", ("t",double((end-start).count())/1000000.0 ) );
+} FC_CAPTURE_AND_RETHROW( (data_dir) ) }
+
+void database::replay_blocks( uint32_t first_block_num, uint32_t last_block_num )
+{
+   // Blocks are replayed with the undo_db disabled unless slow replays were forced.  Plugins that
+   // depend on new/changed/removed object notifications get them from the change journal instead.
+   const bool use_change_journal = !_slow_replays &&
+         ( !new_objects.empty() || !changed_objects.empty() || !removed_objects.empty() );
    if (!_slow_replays)
       _undo_db.disable();
-   for( uint32_t i = 1; i <= last_block_num; ++i )
+   if( use_change_journal )
+      _change_journal.enable();
+   // Blocks are read from the block log in batches on this thread (which only maps them), deserialized and
+   // hashed on the reindex workers, and applied here in order.  At most max_batches are in flight.
+   std::unique_ptr<graphene::utilities::thread_pool> workers;
+   if( _reindex_threads > 0 )
+      workers.reset( new graphene::utilities::thread_pool( "reindex", _reindex_threads ) );
+   const uint32_t batch_size = 100;
+   const size_t max_batches = workers ? 2 * workers->size() : 1;
+
+   std::deque< fc::future< std::shared_ptr<prepared_batch> > > in_flight;
+   auto itr = _block_id_to_block.begin( first_block_num );
+   fc::microseconds read_time, prepare_time, wait_time, apply_time;
+   auto fill_pipeline = [&]()
    {
-      if( i == 1 || 
-          i % 10000 == 0 ) 
-         std::cerr << "   " << double(i*100)/last_block_num << "%   "<< i << " of " <<last_block_num<<"   \n";
-      fc::optional< signed_block > block = _block_id_to_block.fetch_by_number(i);
-      if( !block.valid() )
+      while( in_flight.size() < max_batches && itr.block_num() <= last_block_num )
       {
-         wlog( "Reindexing terminated due to gap:  Block ${i} does not exist!", ("i", i) );
-         uint32_t dropped_count = 0;
-         while( true )
+         auto read_start = fc::time_point::now();
+         std::shared_ptr< vector<block_view> > views = std::make_shared< vector<block_view> >();
+         views->reserve( batch_size );
+         for( ; views->size() < batch_size && itr.block_num() <= last_block_num; ++itr )
+            views->push_back( *itr );
+         read_time += fc::time_point::now() - read_start;
+
+         if( workers )
+            in_flight.push_back( workers->async( [views]() { return prepare_blocks( *views ); }, "reindex prepare" ) );
+         else
          {
-            fc::optional< block_id_type > last_id = _block_id_to_block.last_id();
-            // this can trigger if we attempt to e.g. read a file that has block #2 but no block #1
-            if( !last_id.valid() )
-               break;
-            // we've caught up to the gap
-            if( block_header::num_from_id( *last_id ) <= i )
+            fc::promise< std::shared_ptr<prepared_batch> >::ptr ready(
+               new fc::promise< std::shared_ptr<prepared_batch> >( "reindex prepare" ) );
+            ready->set_value( prepare_blocks( *views ) );
+            in_flight.push_back( fc::future< std::shared_ptr<prepared_batch> >( ready ) );
+         }
+      }
+   };
+
+   // the workers must be done with every batch before the pool goes away, even if a block failed to apply
+   auto finish_replay = [&]()
+   {
+      for( auto& pending : in_flight )
+      {
+         try
+         {
+            pending.wait();
+         }
+         catch( const fc::exception& e )
+         {
+            wlog( "Unable to prepare blocks for replay: ${e}", ("e", e.to_detail_string()) );
+         }
+      }
+      in_flight.clear();
+      if( use_change_journal )
+         _change_journal.disable();
+      if (!_slow_replays)
+         _undo_db.enable();
+   };
+
+   const uint32_t report_interval = 10000;
+   auto report_start = fc::time_point::now();
+   uint32_t i = first_block_num;
+   bool stopped_at_gap = false;
+   try {
+      while( i <= last_block_num && !stopped_at_gap )
+      {
+         fill_pipeline();
+         auto wait_start = fc::time_point::now();
+         std::shared_ptr<prepared_batch> batch = in_flight.front().wait();
+         in_flight.pop_front();
+         wait_time += fc::time_point::now() - wait_start;
+         prepare_time += batch->elapsed;
+
+         for( prepared_block& p : batch->blocks )
+         {
+            if( !p.block.valid() )
+            {
+               wlog( "Reindexing terminated due to gap:  Block ${i} does not exist!", ("i", i) );
+               uint32_t dropped_count = 0;
+               while( true )
+               {
+                  fc::optional< block_id_type > last_id = _block_id_to_block.last_id();
+                  // this can trigger if we attempt to e.g. read a file that has block #2 but no block #1
+                  if( !last_id.valid() )
+                     break;
+                  // we've caught up to the gap
+                  if( block_header::num_from_id( *last_id ) <= i )
+                     break;
+                  _block_id_to_block.remove( *last_id );
+                  dropped_count++;
+               }
+               wlog( "Dropped ${n} blocks from after the gap", ("n", dropped_count) );
+               stopped_at_gap = true;
                break;
-            _block_id_to_block.remove( *last_id );
-            dropped_count++;
+            }
+
+            // a mismatching merkle root is left for _apply_block to report
+            const uint32_t merkle_skip = p.merkle_root_matches ? skip_merkle_check : skip_nothing;
+            auto apply_start = fc::time_point::now();
+            if (_slow_replays)
+               push_block(*p.block, skip_fork_db |
+                                    skip_witness_signature |
+                                    skip_transaction_signatures |
+                                    skip_transaction_dupe_check |
+                                    skip_tapos_check |
+                                    skip_witness_schedule_check |
+                                    skip_authority_check |
+                                    merkle_skip);
+            else
+               apply_block(*p.block, skip_witness_signature |
+                                     skip_transaction_signatures |
+                                     skip_transaction_dupe_check |
+                                     skip_tapos_check |
+                                     skip_witness_schedule_check |
+                                     skip_authority_check |
+                                     merkle_skip);
+            apply_time += fc::time_point::now() - apply_start;
+
+            if( i % report_interval == 0 || i == last_block_num )
+            {
+               const auto now = fc::time_point::now();
+               const uint32_t count = ( i % report_interval == 0 ) ? report_interval : i % report_interval;
+               const int64_t elapsed = std::max<int64_t>( (now - report_start).count(), 1 );
+               ilog( "Replayed ${i} of ${n} blocks (${pct}%): ${bps} blocks/s, per block: read ${r} us, "
+                     "prepare ${p} us, wait ${w} us, apply ${a} us",
+                     ("i", i)("n", last_block_num)("pct", uint64_t(i) * 100 / last_block_num)
+                     ("bps", uint64_t(count) * 1000000 / elapsed)
+                     ("r", read_time.count() / count)("p", prepare_time.count() / count)
+                     ("w", wait_time.count() / count)("a", apply_time.count() / count) );
+               report_start = now;
+               read_time = prepare_time = wait_time = apply_time = fc::microseconds();
+            }
+            ++i;
          }
-         wlog( "Dropped ${n} blocks from after the gap", ("n", dropped_count) );
-         break;
       }
-      if (_slow_replays)
-         push_block(*block, skip_fork_db |
-                            skip_witness_signature |
-                            skip_transaction_signatures |
-                            skip_transaction_dupe_check |
-                            skip_tapos_check |
-                            skip_witness_schedule_check |
-                            skip_authority_check);
-      else
-         apply_block(*block, skip_witness_signature |
-                             skip_transaction_signatures |
-                             skip_transaction_dupe_check |
-                             skip_tapos_check |
-                             skip_witness_schedule_check |
-                             skip_authority_check);
+   } catch( ... ) {
+      finish_replay();
+      throw;
    }
-   if (!_slow_replays)
-     _undo_db.enable();
-   auto end = fc::time_point::now();
-   ilog( "Done reindexing, elapsed time: ${t} sec", ("t",double((end-start).count())/1000000.0 ) );
-} FC_CAPTURE_AND_RETHROW( (data_dir) ) }
+   finish_replay();
+}
 
 void database::wipe(const fc::path& data_dir, bool include_blocks)
 {
@@ -122,7 +277,10 @@ void database::wipe(const fc::path& data_dir, bool include_blocks)
    close();
    object_database::wipe(data_dir);
    if( include_blocks )
+   {
       fc::remove_all( data_dir / "database" );
+      fc::remove_all( data_dir / "state_checkpoint" );
+   }
 }
 
 void database::open(
@@ -134,6 +292,7 @@ void database::open(
       object_database::open(data_dir);
 
       _block_id_to_block.open(data_dir / "database" / "block_num_to_block");
+      reset_state_checkpoints( data_dir );
 
       if( !find(global_property_id_type()) )
          init_genesis(genesis_loader());
@@ -159,6 +318,10 @@ void database::close(bool rewind)
    // TODO:  Save pending tx's on close()
    clear_pending();
 
+   // a capture that has not become irreversible yet is dropped; the full state is flushed below
+   _pending_state_checkpoint.reset();
+   wait_for_state_checkpoint();
+
    // pop all of the blocks that we can given our undo history, this should
    // throw when there is no more undo history to pop
    if( rewind )
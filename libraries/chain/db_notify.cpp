@@ -283,6 +283,7 @@ void transaction_get_impacted_accounts( const transaction& tx, flat_set<account_
     operation_get_impacted_accounts( op, result );
 }
 
+// The id of an object determines its type, so the casts below are static; debug builds still check them.
 void get_relevant_accounts( const object* obj, flat_set<account_id_type>& accounts )
 {
    if( obj->id.space() == protocol_ids )
@@ -297,61 +298,61 @@ void get_relevant_accounts( const object* obj, flat_set<account_id_type>& accoun
            accounts.insert( obj->id );
            break;
         } case asset_object_type:{
-           const auto& aobj = dynamic_cast<const asset_object*>(obj);
-           assert( aobj != nullptr );
+           const auto& aobj = static_cast<const asset_object*>(obj);
+           assert( dynamic_cast<const asset_object*>(obj) != nullptr );
            accounts.insert( aobj->issuer );
            break;
         } case force_settlement_object_type:{
-           const auto& aobj = dynamic_cast<const force_settlement_object*>(obj);
-           assert( aobj != nullptr );
+           const auto& aobj = static_cast<const force_settlement_object*>(obj);
+           assert( dynamic_cast<const force_settlement_object*>(obj) != nullptr );
            accounts.insert( aobj->owner );
            break;
         } case committee_member_object_type:{
-           const auto& aobj = dynamic_cast<const committee_member_object*>(obj);
-           assert( aobj != nullptr );
+           const auto& aobj = static_cast<const committee_member_object*>(obj);
+           assert( dynamic_cast<const committee_member_object*>(obj) != nullptr );
            accounts.insert( aobj->committee_member_account );
            break;
         } case witness_object_type:{
-           const auto& aobj = dynamic_cast<const witness_object*>(obj);
-           assert( aobj != nullptr );
+           const auto& aobj = static_cast<const witness_object*>(obj);
+           assert( dynamic_cast<const witness_object*>(obj) != nullptr );
            accounts.insert( aobj->witness_account );
            break;
         } case limit_order_object_type:{
-           const auto& aobj = dynamic_cast<const limit_order_object*>(obj);
-           assert( aobj != nullptr );
+           const auto& aobj = static_cast<const limit_order_object*>(obj);
+           assert( dynamic_cast<const limit_order_object*>(obj) != nullptr );
            accounts.insert( aobj->seller );
            break;
         } case call_order_object_type:{
-           const auto& aobj = dynamic_cast<const call_order_object*>(obj);
-           assert( aobj != nullptr );
+           const auto& aobj = static_cast<const call_order_object*>(obj);
+           assert( dynamic_cast<const call_order_object*>(obj) != nullptr );
            accounts.insert( aobj->borrower );
            break;
         } case custom_object_type:{
           break;
         } case proposal_object_type:{
-           const auto& aobj = dynamic_cast<const proposal_object*>(obj);
-           assert( aobj != nullptr );
+           const auto& aobj = static_cast<const proposal_object*>(obj);
+           assert( dynamic_cast<const proposal_object*>(obj) != nullptr );
            transaction_get_impacted_accounts( aobj->proposed_transaction, accounts );
            break;
         } case operation_history_object_type:{
-           const auto& aobj = dynamic_cast<const operation_history_object*>(obj);
-           assert( aobj != nullptr );
+           const auto& aobj = static_cast<const operation_history_object*>(obj);
+           assert( dynamic_cast<const operation_history_object*>(obj) != nullptr );
            operation_get_impacted_accounts( aobj->op, accounts );
            break;
         } case withdraw_permission_object_type:{
-           const auto& aobj = dynamic_cast<const withdraw_permission_object*>(obj);
-           assert( aobj != nullptr );
+           const auto& aobj = static_cast<const withdraw_permission_object*>(obj);
+           assert( dynamic_cast<const withdraw_permission_object*>(obj) != nullptr );
            accounts.insert( aobj->withdraw_from_account );
            accounts.insert( aobj->authorized_account );
            break;
         } case vesting_balance_object_type:{
-           const auto& aobj = dynamic_cast<const vesting_balance_object*>(obj);
-           assert( aobj != nullptr );
+           const auto& aobj = static_cast<const vesting_balance_object*>(obj);
+           assert( dynamic_cast<const vesting_balance_object*>(obj) != nullptr );
            accounts.insert( aobj->owner );
            break;
         } case worker_object_type:{
-           const auto& aobj = dynamic_cast<const worker_object*>(obj);
-           assert( aobj != nullptr );
+           const auto& aobj = static_cast<const worker_object*>(obj);
+           assert( dynamic_cast<const worker_object*>(obj) != nullptr );
            accounts.insert( aobj->worker_account );
            break;
         } case balance_object_type:{
@@ -375,23 +376,23 @@ void get_relevant_accounts( const object* obj, flat_set<account_id_type>& accoun
              case impl_asset_bitasset_data_type:
               break;
              case impl_account_balance_object_type:{
-              const auto& aobj = dynamic_cast<const account_balance_object*>(obj);
-              assert( aobj != nullptr );
+              const auto& aobj = static_cast<const account_balance_object*>(obj);
+              assert( dynamic_cast<const account_balance_object*>(obj) != nullptr );
               accounts.insert( aobj->owner );
               break;
            } case impl_account_statistics_object_type:{
-              const auto& aobj = dynamic_cast<const account_statistics_object*>(obj);
-              assert( aobj != nullptr );
+              const auto& aobj = static_cast<const account_statistics_object*>(obj);
+              assert( dynamic_cast<const account_statistics_object*>(obj) != nullptr );
               accounts.insert( aobj->owner );
               break;
            } case impl_transaction_object_type:{
-              const auto& aobj = dynamic_cast<const transaction_object*>(obj);
-              assert( aobj != nullptr );
+              const auto& aobj = static_cast<const transaction_object*>(obj);
+              assert( dynamic_cast<const transaction_object*>(obj) != nullptr );
               transaction_get_impacted_accounts( aobj->trx, accounts );
               break;
            } case impl_blinded_balance_object_type:{
-              const auto& aobj = dynamic_cast<const blinded_balance_object*>(obj);
-              assert( aobj != nullptr );
+              const auto& aobj = static_cast<const blinded_balance_object*>(obj);
+              assert( dynamic_cast<const blinded_balance_object*>(obj) != nullptr );
               for( const auto& a : aobj->owner.account_auths )
                 accounts.insert( a.first );
               break;
@@ -417,58 +418,112 @@ void get_relevant_accounts( const object* obj, flat_set<account_id_type>& accoun
 
 namespace graphene { namespace chain {
 
-void database::notify_changed_objects()
-{ try {
-   if( _undo_db.enabled() ) 
-   {
-      const auto& head_undo = _undo_db.head();
-
-      // New
-      if( !new_objects.empty() )
-      {
-        vector<object_id_type> new_ids;  new_ids.reserve(head_undo.new_ids.size());
-        flat_set<account_id_type> new_accounts_impacted;
-        for( const auto& item : head_undo.new_ids )
-        {
-          new_ids.push_back(item);
-          auto obj = find_object(item);
-          if(obj != nullptr)
-            get_relevant_accounts(obj, new_accounts_impacted);
-        }
+std::shared_ptr<void> database::impacted_accounts_listener( bool wants_accounts )
+{
+   if( !wants_accounts )
+      return std::shared_ptr<void>();
+   // the connection keeps the counter alive, it may outlive the database
+   std::shared_ptr<uint32_t> listeners = _impacted_accounts_listeners;
+   ++*listeners;
+   return std::shared_ptr<void>( nullptr, [listeners]( void* ) { --*listeners; } );
+}
 
-        new_objects(new_ids, new_accounts_impacted);
-      }
+boost::signals2::connection database::connect_new_objects(
+      const std::function<void(const vector<object_id_type>&, const flat_set<account_id_type>&)>& slot,
+      bool wants_accounts )
+{
+   std::shared_ptr<void> listener = impacted_accounts_listener( wants_accounts );
+   return new_objects.connect( [slot, listener]( const vector<object_id_type>& ids, const flat_set<account_id_type>& accounts ) {
+      slot( ids, accounts );
+   });
+}
 
-      // Changed
-      if( !changed_objects.empty() )
-      {
-        vector<object_id_type> changed_ids;  changed_ids.reserve(head_undo.old_values.size());
-        flat_set<account_id_type> changed_accounts_impacted;
-        for( const auto& item : head_undo.old_values )
-        {
-          changed_ids.push_back(item.first);
-          get_relevant_accounts(item.second.get(), changed_accounts_impacted);
-        }
+boost::signals2::connection database::connect_changed_objects(
+      const std::function<void(const vector<object_id_type>&, const flat_set<account_id_type>&)>& slot,
+      bool wants_accounts )
+{
+   std::shared_ptr<void> listener = impacted_accounts_listener( wants_accounts );
+   return changed_objects.connect( [slot, listener]( const vector<object_id_type>& ids, const flat_set<account_id_type>& accounts ) {
+      slot( ids, accounts );
+   });
+}
 
-        changed_objects(changed_ids, changed_accounts_impacted);
-      }
+boost::signals2::connection database::connect_removed_objects(
+      const std::function<void(const vector<object_id_type>&, const vector<const object*>&,
+                               const flat_set<account_id_type>&)>& slot,
+      bool wants_accounts )
+{
+   std::shared_ptr<void> listener = impacted_accounts_listener( wants_accounts );
+   return removed_objects.connect( [slot, listener]( const vector<object_id_type>& ids, const vector<const object*>& objs,
+                                                     const flat_set<account_id_type>& accounts ) {
+      slot( ids, objs, accounts );
+   });
+}
 
-      // Removed
-      if( !removed_objects.empty() )
-      {
-        vector<object_id_type> removed_ids; removed_ids.reserve( head_undo.removed.size() );
-        vector<const object*> removed; removed.reserve( head_undo.removed.size() );
-        flat_set<account_id_type> removed_accounts_impacted;
-        for( const auto& item : head_undo.removed )
-        {
-          removed_ids.emplace_back( item.first );
-          auto obj = item.second.get();
-          removed.emplace_back( obj );
-          get_relevant_accounts(obj, removed_accounts_impacted);
-        }
+void database::notify_changed_objects()
+{
+   if( _undo_db.enabled() )
+      notify_changed_objects( _undo_db.head() );
+   else if( _change_journal.enabled() )
+      notify_changed_objects( _change_journal.changes() );
+   _change_journal.clear();
+}
 
-        removed_objects(removed_ids, removed, removed_accounts_impacted);
-      }
+void database::notify_changed_objects( const undo_state& changes )
+{ try {
+   if( new_objects.empty() && changed_objects.empty() && removed_objects.empty() )
+      return;
+   const bool find_accounts = *_impacted_accounts_listeners > 0;
+
+   // New
+   if( !new_objects.empty() )
+   {
+     vector<object_id_type> new_ids;  new_ids.reserve(changes.new_ids.size());
+     flat_set<account_id_type> new_accounts_impacted;
+     for( const auto& item : changes.new_ids )
+     {
+       new_ids.push_back(item);
+       if( !find_accounts )
+         continue;
+       auto obj = find_object(item);
+       if(obj != nullptr)
+         get_relevant_accounts(obj, new_accounts_impacted);
+     }
+
+     new_objects(new_ids, new_accounts_impacted);
+   }
+
+   // Changed
+   if( !changed_objects.empty() )
+   {
+     vector<object_id_type> changed_ids;  changed_ids.reserve(changes.old_values.size());
+     flat_set<account_id_type> changed_accounts_impacted;
+     for( const auto& item : changes.old_values )
+     {
+       changed_ids.push_back(item.first);
+       if( find_accounts )
+         get_relevant_accounts(item.second.get(), changed_accounts_impacted);
+     }
+
+     changed_objects(changed_ids, changed_accounts_impacted);
+   }
+
+   // Removed
+   if( !removed_objects.empty() )
+   {
+     vector<object_id_type> removed_ids; removed_ids.reserve( changes.removed.size() );
+     vector<const object*> removed; removed.reserve( changes.removed.size() );
+     flat_set<account_id_type> removed_accounts_impacted;
+     for( const auto& item : changes.removed )
+     {
+       removed_ids.emplace_back( item.first );
+       auto obj = item.second.get();
+       removed.emplace_back( obj );
+       if( find_accounts )
+         get_relevant_accounts(obj, removed_accounts_impacted);
+     }
+
+     removed_objects(removed_ids, removed, removed_accounts_impacted);
    }
 } FC_CAPTURE_AND_LOG( (0) ) }
 
@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/state_checkpoint.hpp>
+
+#include <graphene/utilities/thread_pool.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <fstream>
+#include <set>
+
+#ifndef WIN32
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+namespace graphene { namespace chain {
+
+namespace {
+
+   /// flushes a file, or the entries of a directory, to stable storage
+   void sync_to_disk( const fc::path& path )
+   {
+#ifndef WIN32
+      int fd = ::open( path.generic_string().c_str(), O_RDONLY );
+      FC_ASSERT( fd >= 0, "Unable to open ${f} to sync it", ("f", path) );
+      const int result = ::fsync( fd );
+      ::close( fd );
+      FC_ASSERT( result == 0, "Unable to sync ${f}", ("f", path) );
+#endif
+   }
+
+   /**
+    *  Runs on the checkpoint thread; only touches the files and the capture.  Every file is synced before it is
+    *  renamed, and the directory after the renames, so that after a power loss the manifest never names a file
+    *  whose content did not reach the disk.
+    */
+   void write_state_checkpoint_files( const fc::path& dir, const state_checkpoint_capture& capture )
+   {
+      fc::create_directories( dir );
+      for( const auto& file : capture.files )
+      {
+         const fc::path tmp = dir / ( file.first + ".tmp" );
+         {
+            std::ofstream out( tmp.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+            FC_ASSERT( out, "Unable to create ${f}", ("f", tmp) );
+            out << file.second->rdbuf();
+            out.close();
+            FC_ASSERT( out, "Unable to write ${f}", ("f", tmp) );
+         }
+         sync_to_disk( tmp );
+         fc::rename( tmp, dir / file.first );
+      }
+      sync_to_disk( dir );
+
+      // the checkpoint only becomes visible once the manifest naming its files is renamed into place
+      fc::json::save_to_file( capture.manifest, dir / "manifest.tmp" );
+      sync_to_disk( dir / "manifest.tmp" );
+      fc::rename( dir / "manifest.tmp", dir / "manifest" );
+      sync_to_disk( dir );
+
+      std::set<std::string> keep;
+      keep.insert( "manifest" );
+      for( const auto& entry : capture.manifest.indexes )
+         keep.insert( entry.file );
+      vector<fc::path> obsolete;
+      for( fc::directory_iterator itr( dir ); itr != fc::directory_iterator(); ++itr )
+         if( keep.find( (*itr).filename().generic_string() ) == keep.end() )
+            obsolete.push_back( *itr );
+      for( const auto& path : obsolete )
+         fc::remove( path );
+   }
+
+} // anonymous namespace
+
+void database::reset_state_checkpoints( const fc::path& data_dir )
+{
+   _state_checkpoint_dir = data_dir / "state_checkpoint";
+   _state_checkpoint_files.clear();
+   _pending_state_checkpoint.reset();
+   // new files must not collide with those of the checkpoint already on disk
+   if( fc::exists( _state_checkpoint_dir / "manifest" ) )
+   {
+      try
+      {
+         auto manifest = fc::json::from_file( _state_checkpoint_dir / "manifest" ).as<state_checkpoint_manifest>();
+         _state_checkpoint_generation = std::max( _state_checkpoint_generation, manifest.generation );
+      }
+      catch( const fc::exception& e )
+      {
+         wlog( "Ignoring unreadable state checkpoint manifest: ${e}", ("e", e.to_detail_string()) );
+      }
+   }
+}
+
+bool database::open_from_state_checkpoint( const fc::path& data_dir )
+{ try {
+   const fc::path dir = data_dir / "state_checkpoint";
+   if( !fc::exists( dir / "manifest" ) )
+      return false;
+   state_checkpoint_manifest manifest;
+   try
+   {
+      manifest = fc::json::from_file( dir / "manifest" ).as<state_checkpoint_manifest>();
+   }
+   catch( const fc::exception& e )
+   {
+      wlog( "Ignoring unreadable state checkpoint manifest: ${e}", ("e", e.to_detail_string()) );
+      return false;
+   }
+   for( const auto& entry : manifest.indexes )
+      if( !fc::exists( dir / entry.file ) || fc::file_size( dir / entry.file ) != entry.size )
+      {
+         wlog( "State checkpoint at block ${n} is missing ${f} or it is incomplete", ("n", manifest.block_num)("f", entry.file) );
+         return false;
+      }
+
+   _block_id_to_block.open( data_dir / "database" / "block_num_to_block" );
+   fc::optional<signed_block> last_block = _block_id_to_block.last();
+   if( !last_block.valid() || !_block_id_to_block.contains( manifest.block_id ) )
+   {
+      wlog( "State checkpoint at block ${n} is not part of the block log", ("n", manifest.block_num) );
+      _block_id_to_block.close();
+      return false;
+   }
+
+   ilog( "Loading state checkpoint at block ${n}", ("n", manifest.block_num) );
+   const bool undo_enabled = _undo_db.enabled();
+   try
+   {
+      // object files left behind by the unclean shutdown are not consistent with anything
+      object_database::wipe( data_dir );
+      // a failed open() before this may have loaded part of the state
+      object_database::clear();
+      std::map< std::pair<uint8_t,uint8_t>, fc::path > files;
+      for( const auto& entry : manifest.indexes )
+         files[ std::make_pair( entry.space, entry.type ) ] = dir / entry.file;
+      object_database::open( data_dir, files );
+      FC_ASSERT( find( global_property_id_type() ) && head_block_id() == manifest.block_id,
+                 "State checkpoint does not contain the state at block ${id}", ("id", manifest.block_id) );
+
+      reset_state_checkpoints( data_dir );
+      for( const auto& entry : manifest.indexes )
+         _state_checkpoint_files[ std::make_pair( entry.space, entry.type ) ] =
+            std::make_pair( entry, get_index( entry.space, entry.type ).get_revision() );
+
+      _fork_db.start_block( *last_block );
+      ilog( "Replaying blocks ${f} to ${l} after the state checkpoint",
+            ("f", manifest.block_num + 1)("l", last_block->block_num()) );
+      replay_blocks( manifest.block_num + 1, last_block->block_num() );
+   }
+   catch( const fc::exception& e )
+   {
+      // the state may be half loaded or half replayed here; drop it so that the caller can replay from genesis,
+      // and keep this checkpoint from being tried again
+      elog( "Unable to load state checkpoint, falling back to a replay: ${e}", ("e", e.to_detail_string()) );
+      fc::rename( dir / "manifest", dir / "manifest.bad" );
+      _change_journal.disable();
+      if( undo_enabled )
+         _undo_db.enable();
+      else
+         _undo_db.disable();
+      object_database::clear();
+      reset_state_checkpoints( data_dir );
+      _fork_db.reset();
+      _block_id_to_block.close();
+      return false;
+   }
+   return true;
+} FC_CAPTURE_AND_RETHROW( (data_dir) ) }
+
+void database::wait_for_state_checkpoint()
+{
+   if( !_state_checkpoint_write.valid() )
+      return;
+   try
+   {
+      _state_checkpoint_write.wait();
+   }
+   catch( const fc::exception& e )
+   {
+      // the files of the previous checkpoint may not exist, so the next one rewrites every index
+      elog( "Writing state checkpoint failed: ${e}", ("e", e.to_detail_string()) );
+      _state_checkpoint_files.clear();
+   }
+   _state_checkpoint_write = fc::future<void>();
+}
+
+void database::update_state_checkpoint()
+{ try {
+   if( _state_checkpoint_interval == 0 || _state_checkpoint_dir == fc::path() )
+      return;
+
+   const uint32_t last_irreversible = get_dynamic_global_properties().last_irreversible_block_num;
+   if( _pending_state_checkpoint && _pending_state_checkpoint->manifest.block_num <= last_irreversible )
+   {
+      std::unique_ptr<state_checkpoint_capture> capture = std::move( _pending_state_checkpoint );
+      const uint32_t num = capture->manifest.block_num;
+      if( num <= head_block_num() && get_block_id_for_num( num ) == capture->manifest.block_id )
+         write_state_checkpoint( std::move( capture ) );
+      else
+         wlog( "Dropping state checkpoint at block ${n}, the block was switched out by a fork", ("n", num) );
+   }
+
+   const bool writing = _state_checkpoint_write.valid() && !_state_checkpoint_write.ready();
+   if( !_pending_state_checkpoint && head_block_num() % _state_checkpoint_interval == 0 )
+   {
+      if( writing )
+      {
+         wlog( "Skipping state checkpoint at block ${n}, the previous one is still being written", ("n", head_block_num()) );
+         return;
+      }
+      _pending_state_checkpoint = capture_state_checkpoint();
+      if( head_block_num() <= last_irreversible )
+         write_state_checkpoint( std::move( _pending_state_checkpoint ) );
+   }
+} catch ( const fc::exception& e ) {
+   // a checkpoint is an optimization, failing to take one must not fail the block
+   elog( "Unable to take state checkpoint: ${e}", ("e", e.to_detail_string()) );
+} }
+
+std::unique_ptr<state_checkpoint_capture> database::capture_state_checkpoint()
+{
+   // collect the outcome of the previous write first, a failure invalidates _state_checkpoint_files
+   wait_for_state_checkpoint();
+
+   auto start = fc::time_point::now();
+   std::unique_ptr<state_checkpoint_capture> capture( new state_checkpoint_capture );
+   auto& manifest = capture->manifest;
+   manifest.generation = ++_state_checkpoint_generation;
+   manifest.block_num = head_block_num();
+   manifest.block_id = head_block_id();
+
+   inspect_all_indexes( [&]( const index& idx ) {
+      const auto key = std::make_pair( idx.object_space_id(), idx.object_type_id() );
+      const uint64_t revision = idx.get_revision();
+      state_checkpoint_file entry;
+      entry.space = key.first;
+      entry.type = key.second;
+
+      auto previous = _state_checkpoint_files.find( key );
+      if( previous != _state_checkpoint_files.end() && previous->second.second == revision )
+         entry = previous->second.first;
+      else
+      {
+         entry.file = fc::to_string( manifest.generation ) + "-" + fc::to_string( uint32_t(entry.space) ) + "-"
+                    + fc::to_string( uint32_t(entry.type) );
+         std::shared_ptr<std::stringstream> content = std::make_shared<std::stringstream>(
+            std::ios_base::in | std::ios_base::out | std::ios_base::binary );
+         idx.save( *content );
+         entry.size = uint64_t( content->tellp() );
+         capture->bytes += entry.size;
+         capture->files.emplace_back( entry.file, content );
+         capture->revisions.emplace_back( key, std::make_pair( entry, revision ) );
+      }
+      manifest.indexes.push_back( entry );
+   });
+
+   ilog( "Captured state checkpoint at block ${n}: ${c} of ${t} indexes changed, ${b} bytes held until irreversible, ${ms} ms",
+         ("n", manifest.block_num)("c", capture->files.size())("t", manifest.indexes.size())("b", capture->bytes)
+         ("ms", (fc::time_point::now() - start).count() / 1000) );
+   return capture;
+}
+
+void database::write_state_checkpoint( std::unique_ptr<state_checkpoint_capture> capture )
+{
+   for( const auto& item : capture->revisions )
+      _state_checkpoint_files[ item.first ] = item.second;
+
+   if( !_state_checkpoint_writer )
+      _state_checkpoint_writer.reset( new graphene::utilities::thread_pool( "state_checkpoint", 1 ) );
+   std::shared_ptr<const state_checkpoint_capture> shared( capture.release() );
+   const fc::path dir = _state_checkpoint_dir;
+   _state_checkpoint_write = _state_checkpoint_writer->async( [shared, dir]() {
+      write_state_checkpoint_files( dir, *shared );
+   }, "write state checkpoint" );
+}
+
+} } // graphene::chain
@@ -34,6 +34,7 @@
 #include <graphene/chain/withdraw_permission_object.hpp>
 #include <graphene/chain/witness_object.hpp>
 #include <graphene/chain/tournament_object.hpp>
+#include <graphene/chain/match_object.hpp>
 #include <graphene/chain/game_object.hpp>
 #include <graphene/chain/betting_market_object.hpp>
 
@@ -60,8 +61,9 @@ void database::update_global_dynamic_data( const signed_block& b )
 //     if (gpo.parameters.witness_schedule_algorithm == GRAPHENE_WITNESS_SHUFFLED_ALGORITHM)
 //     {
        missed_blocks--;
+       const vector<witness_id_type> missed_witnesses = get_scheduled_witnesses( 1, missed_blocks );
        for( uint32_t i = 0; i < missed_blocks; ++i ) {
-          const auto& witness_missed = get_scheduled_witness( i+1 )(*this);
+          const auto& witness_missed = missed_witnesses[i](*this);
           if(  witness_missed.id != b.witness ) {
              /*
              const auto& witness_account = witness_missed.witness_account(*this);
@@ -194,45 +196,24 @@ void database::place_delayed_bets()
    // If any bets have been placed during live betting where bets are delayed for a few seconds, see if there are
    // any bets whose delays have expired.
 
-   // Delayed bets are sorted to the beginning of the order book, so if there are any bets that need placing, 
-   // they're right at the front of the book
-   const auto& bet_odds_idx = get_index_type<bet_object_index>().indices().get<by_odds>();
-   auto iter = bet_odds_idx.begin();
-
-   // we use an awkward looping mechanism here because there's a case where we are processing the
-   // last delayed bet before the "real" order book starts and `iter` was pointing at the first 
-   // real order.  The place_bet() call can cause the that real order to be deleted, so we need
-   // to decide whether this is the last delayed bet before `place_bet` is called.
-   bool last = iter == bet_odds_idx.end() || 
-               !iter->end_of_delay ||
-               *iter->end_of_delay > head_block_time();
-   while (!last)
-   {
-      const bet_object& bet_to_place = *iter;
-      ++iter;
-
-      last = iter == bet_odds_idx.end() || 
-             !iter->end_of_delay ||
-             *iter->end_of_delay > head_block_time();
-
-      // it's possible that the betting market was active when the bet was placed,
-      // but has been frozen before the delay expired.  If that's the case here,
-      // don't try to match the bet.
-      // Since this check happens every block, this could impact performance if a
-      // market with many delayed bets is frozen for a long time.
-      // Our current understanding is that the witnesses will typically cancel all unmatched
-      // bets on frozen markets to avoid this.
-      const betting_market_object& betting_market = bet_to_place.betting_market_id(*this);
-      if (betting_market.get_status() == betting_market_status::unresolved)
-      {
-         modify(bet_to_place, [](bet_object& bet_obj) {
-            // clear the end_of_delay,  which will re-sort the bet into its place in the book
-            bet_obj.end_of_delay.reset();
-         });
+   // it's possible that the betting market was active when the bet was placed,
+   // but has been frozen before the delay expired.  If that's the case here,
+   // don't try to match the bet.  The status is checked once per market rather
+   // than once per bet, so a frozen market with many delayed bets costs no more
+   // each block than one with a single delayed bet.
+   flat_set<betting_market_id_type> markets_to_place;
+   for (const betting_market_id_type& betting_market_id : _bet_order_book->markets_with_ended_delays(head_block_time()))
+      if (betting_market_id(*this).get_status() == betting_market_status::unresolved)
+         markets_to_place.insert(betting_market_id);
+
+   for_each_delayed_bet(markets_to_place, head_block_time(), [this](const bet_object& bet_to_place) {
+      modify(bet_to_place, [](bet_object& bet_obj) {
+         // clear the end_of_delay,  which will re-sort the bet into its place in the book
+         bet_obj.end_of_delay.reset();
+      });
 
-         place_bet(bet_to_place);
-      }
-   }
+      place_bet(bet_to_place);
+   });
 } FC_CAPTURE_AND_RETHROW() }
 
 void database::clear_expired_proposals()
@@ -557,17 +538,20 @@ void process_finished_matches(database& db)
 {
 }
 
-void process_in_progress_tournaments(database& db)
+void database::process_in_progress_tournaments()
 {
-   auto& start_time_index = db.get_index_type<tournament_index>().indices().get<by_start_time>();
-   auto start_iter = start_time_index.lower_bound(boost::make_tuple(tournament_state::in_progress));
-   while (start_iter != start_time_index.end() &&
-          start_iter->get_state() == tournament_state::in_progress)
+   // Only a tournament whose matches changed since it was last checked can have new matches to start,
+   // so there is no need to walk every tournament in progress
+   std::set<tournament_id_type> active_tournaments = _match_activity->take_active_tournaments();
+   for (const tournament_id_type& tournament_id : active_tournaments)
    {
-      auto next_iter = std::next(start_iter);
-      start_iter->check_for_new_matches_to_start(db);
-      start_iter = next_iter;
+      const tournament_object* tournament_obj = find(tournament_id);
+      if (tournament_obj && tournament_obj->get_state() == tournament_state::in_progress)
+         tournament_obj->check_for_new_matches_to_start(*this);
    }
+   // checking a tournament again right away would change nothing, so the matches the
+   // checks themselves modified don't need another visit
+   _match_activity->unmark(active_tournaments);
 }
 
 void cancel_expired_tournaments(database& db)
@@ -650,7 +634,7 @@ void database::update_tournaments()
    process_finished_matches(*this);
    cancel_expired_tournaments(*this);
    start_fully_registered_tournaments(*this);
-   process_in_progress_tournaments(*this);
+   process_in_progress_tournaments();
    initiate_next_round_of_matches(*this);
    initiate_next_games(*this);
 }
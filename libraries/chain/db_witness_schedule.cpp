@@ -52,14 +52,9 @@ witness_id_type database::get_scheduled_witness( uint32_t slot_num )const
        {
           // if the near scheduler doesn't know, we have to extend it to
           //   a far scheduler.
-          // n.b. instantiating it is slow, but block gaps long enough to
-          //   need it are likely pretty rare.
-
-          witness_scheduler_rng far_rng(wso.rng_seed.begin(), GRAPHENE_FAR_SCHEDULE_CTR_IV);
-
-          far_future_witness_scheduler far_scheduler =
-             far_future_witness_scheduler(wso.scheduler, far_rng);
-          if(!far_scheduler.get_slot(slot_num-1, wid))
+          // n.b. the far scheduler is slow to instantiate, so it is kept
+          //   until the witness schedule object changes.
+          if(!get_far_future_scheduler(wso).get_slot(slot_num-1, wid))
           {
              // no scheduled witness -- somebody set up us the bomb
              // n.b. this code path is impossible, the present
@@ -72,6 +67,59 @@ witness_id_type database::get_scheduled_witness( uint32_t slot_num )const
    return wid;
 }
 
+vector<witness_id_type> database::get_scheduled_witnesses( uint32_t first_slot, uint32_t count )const
+{
+   vector<witness_id_type> result;
+   result.reserve( count );
+   const global_property_object& gpo = get_global_properties();
+   if (gpo.parameters.witness_schedule_algorithm == GRAPHENE_WITNESS_SHUFFLED_ALGORITHM)
+   {
+      const dynamic_global_property_object& dpo = get_dynamic_global_properties();
+      const witness_schedule_object& wso = witness_schedule_id_type()(*this);
+      for( uint32_t i = 0; i < count; ++i )
+      {
+         uint64_t current_aslot = dpo.current_aslot + first_slot + i;
+         result.push_back( wso.current_shuffled_witnesses[ current_aslot % wso.current_shuffled_witnesses.size() ] );
+      }
+   }
+   else if (gpo.parameters.witness_schedule_algorithm == GRAPHENE_WITNESS_SCHEDULED_ALGORITHM)
+   {
+      const witness_schedule_object& wso = witness_schedule_id_type()(*this);
+      const far_future_witness_scheduler* far_scheduler = nullptr;
+      for( uint32_t i = 0; i < count; ++i )
+      {
+         uint32_t slot_num = first_slot + i;
+         witness_id_type wid;
+         if( slot_num != 0 && !wso.scheduler.get_slot(slot_num-1, wid) )
+         {
+            if( far_scheduler == nullptr )
+               far_scheduler = &get_far_future_scheduler(wso);
+            far_scheduler->get_slot(slot_num-1, wid);
+         }
+         result.push_back( wid );
+      }
+   }
+   else
+      result.resize( count );
+   return result;
+}
+
+const far_future_witness_scheduler& database::get_far_future_scheduler( const witness_schedule_object& wso )const
+{
+   fc::sha256::encoder enc;
+   fc::raw::pack( enc, wso.scheduler );
+   fc::raw::pack( enc, wso.rng_seed );
+   fc::sha256 state_digest = enc.result();
+
+   if( !_far_future_schedule.scheduler || _far_future_schedule.state_digest != state_digest )
+   {
+      witness_scheduler_rng far_rng(wso.rng_seed.begin(), GRAPHENE_FAR_SCHEDULE_CTR_IV);
+      _far_future_schedule.scheduler = far_future_witness_scheduler(wso.scheduler, far_rng);
+      _far_future_schedule.state_digest = state_digest;
+   }
+   return *_far_future_schedule.scheduler;
+}
+
 fc::time_point_sec database::get_slot_time(uint32_t slot_num)const
 {
    if( slot_num == 0 )
@@ -376,6 +376,31 @@ namespace graphene { namespace chain {
     */
    typedef generic_index<account_balance_object, account_balance_object_multi_index_type> account_balance_index;
 
+   /**
+    *  @brief This secondary index maintains the number of accounts that hold a non-zero balance of each asset.
+    */
+   class asset_holders_count_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_restored( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         /** @return the number of accounts with a non-zero balance of asset_id */
+         uint32_t count( asset_id_type asset_id )const;
+
+      protected:
+         void add_holder( asset_id_type asset_id );
+         void remove_holder( asset_id_type asset_id );
+
+         map< asset_id_type, uint32_t > holders;
+
+         asset_id_type  before_asset;
+         bool           before_held = false;
+   };
+
    struct by_name{};
 
    /**
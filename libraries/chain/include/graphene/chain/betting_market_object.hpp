@@ -30,6 +30,10 @@
 
 #include <boost/multi_index/composite_key.hpp>
 
+#include <functional>
+#include <map>
+#include <set>
+
 namespace graphene { namespace chain {
    class betting_market_object;
    class betting_market_group_object;
@@ -605,6 +609,86 @@ typedef multi_index_container<
       ordered_unique< tag<by_bettor_and_odds>, identity<bet_object>, compare_bet_by_bettor_then_odds > > > bet_object_multi_index_type;
 typedef generic_index<bet_object, bet_object_multi_index_type> bet_object_index;
 
+/**
+ * @class bet_order_book_index
+ * @brief the order book of every betting market, kept up to date alongside bet_object_index
+ *
+ * Bets that are not delayed are grouped into price levels keyed by backer_multiplier.  Each level holds its
+ * bets in time priority (lowest id first), and levels are kept best odds first, so walking the book gives
+ * the same order as the non-delayed part of the by_odds index without comparing end_of_delay at every step.
+ * Bets still within their live betting delay are kept apart, ordered by end_of_delay, and each market with delayed
+ * bets is also filed under the delay that ends first, so the markets whose delays have ended can be found without
+ * walking the delayed bets of every other market.
+ */
+class bet_order_book_index : public secondary_index
+{
+   public:
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_restored( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after ) override;
+
+      /**
+       * @return the bet that a new bet at backer_multiplier would be matched against first: the oldest bet of
+       * type_to_match at the best odds that still cross backer_multiplier, or an invalid optional if none do
+       */
+      optional<bet_id_type> best_match( betting_market_id_type betting_market_id, bet_type type_to_match,
+                                        bet_multiplier_type backer_multiplier )const;
+
+      /// a delayed bet, keyed the way the by_odds index orders delayed bets
+      typedef std::pair<time_point_sec, bet_id_type> delay_key;
+
+      /// @return the delayed bet of betting_market_id whose delay ends first, or an invalid optional if it has none
+      optional<delay_key> first_delayed_bet( betting_market_id_type betting_market_id )const;
+
+      /// @return the markets holding at least one bet whose delay ended at or before now
+      vector<betting_market_id_type> markets_with_ended_delays( time_point_sec now )const;
+
+   private:
+      typedef std::set<bet_id_type> price_level;
+
+      struct market_book
+      {
+         /// back bets, lowest multiplier (best for a layer) first
+         std::map<bet_multiplier_type, price_level>                                     back_levels;
+         /// lay bets, highest multiplier (best for a backer) first
+         std::map<bet_multiplier_type, price_level, std::greater<bet_multiplier_type> > lay_levels;
+         std::set<delay_key>                                                            delayed_bets;
+
+         bool empty()const { return back_levels.empty() && lay_levels.empty() && delayed_bets.empty(); }
+      };
+
+      /// the fields of a bet that decide where it sits in the book
+      struct book_position
+      {
+         betting_market_id_type   betting_market_id;
+         bet_type                 back_or_lay = bet_type::back;
+         bet_multiplier_type      backer_multiplier = 0;
+         optional<time_point_sec> end_of_delay;
+         bet_id_type              bet_id;
+
+         bool operator == ( const book_position& o )const
+         {
+            return betting_market_id == o.betting_market_id && back_or_lay == o.back_or_lay &&
+                   backer_multiplier == o.backer_multiplier && bet_id == o.bet_id &&
+                   !end_of_delay == !o.end_of_delay && (!end_of_delay || *end_of_delay == *o.end_of_delay);
+         }
+      };
+
+      static book_position position_of( const object& obj );
+      void add( const book_position& pos );
+      void remove( const book_position& pos );
+
+      void refile_delays( betting_market_id_type betting_market_id, const optional<delay_key>& old_first,
+                          const optional<delay_key>& new_first );
+
+      std::map<betting_market_id_type, market_book>               _books;
+      /// every market with delayed bets, keyed by its delayed bet whose delay ends first
+      std::set< std::pair<delay_key, betting_market_id_type> >    _markets_by_first_delay;
+      book_position                                               _before_modify;
+};
+
 struct by_bettor_betting_market{};
 struct by_betting_market_bettor{};
 typedef multi_index_container<
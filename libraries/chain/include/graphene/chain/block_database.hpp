@@ -23,12 +23,74 @@
  */
 #pragma once
 #include <fstream>
+#include <memory>
 #include <graphene/chain/protocol/block.hpp>
 
+namespace fc { class mapped_region; }
+
 namespace graphene { namespace chain {
+
+   struct index_entry;
+
+   /**
+    *  A view of one block as it is stored in the block log.  The bytes are read straight from the
+    *  memory mapped log and stay valid for as long as the view exists, even if the log is remapped
+    *  or closed in the meantime.  The block is only deserialized on request.
+    */
+   class block_view
+   {
+      public:
+         block_view() {}
+         block_view( std::shared_ptr<const fc::mapped_region> region, const char* data, uint32_t size,
+                     const block_id_type& id );
+
+         bool                 valid()const { return _data != nullptr; }
+         const block_id_type& id()const { return _id; }
+         uint32_t             block_num()const { return block_header::num_from_id( _id ); }
+         const char*          data()const { return _data; }
+         uint32_t             size()const { return _size; }
+
+         /** Deserializes the block and checks that it matches id() */
+         signed_block         unpack()const;
+
+      private:
+         std::shared_ptr<const fc::mapped_region> _region;
+         const char*                              _data = nullptr;
+         uint32_t                                 _size = 0;
+         block_id_type                            _id;
+   };
+
+   /**
+    *  Append-only block log.  Blocks are appended to the "blocks" file and located through the
+    *  "index" file, which holds one fixed size entry per block number.  Both files are read
+    *  through memory mappings which are extended lazily as the files grow; writes go through
+    *  regular file streams.
+    */
    class block_database 
    {
       public:
+         /**
+          *  Sequential cursor over the log in ascending block number order.  At a block number
+          *  that has no stored block the cursor is not valid(), but it can still be advanced.
+          */
+         class iterator
+         {
+            public:
+               bool              valid()const { return _view.valid(); }
+               uint32_t          block_num()const { return _block_num; }
+               const block_view& operator*()const { return _view; }
+               const block_view* operator->()const { return &_view; }
+               iterator&         operator++();
+
+            private:
+               friend class block_database;
+               iterator( const block_database& db, uint32_t block_num );
+
+               const block_database* _db = nullptr;
+               uint32_t              _block_num = 0;
+               block_view            _view;
+         };
+
          void open( const fc::path& dbdir );
          bool is_open()const;
          void flush();
@@ -43,8 +105,32 @@ namespace graphene { namespace chain {
          optional<signed_block> fetch_by_number( uint32_t block_num )const;
          optional<signed_block> last()const;
          optional<block_id_type> last_id()const;
+
+         /** @return the stored bytes of a block without deserializing them, or an invalid view */
+         block_view             fetch_view( const block_id_type& id )const;
+         block_view             fetch_view_by_number( uint32_t block_num )const;
+
+         /** @return a cursor positioned at @p first_block_num */
+         iterator               begin( uint32_t first_block_num = 1 )const;
+
       private:
+         struct mapped_file
+         {
+            fc::path                                 path;
+            std::shared_ptr<const fc::mapped_region> region;
+            uint64_t                                 mapped_size = 0;
+         };
+
+         const char* map_range( mapped_file& file, std::fstream& stream, uint64_t end )const;
+         bool        read_index_entry( uint32_t block_num, index_entry& e )const;
+         block_view  view_of( const index_entry& e )const;
+         optional<uint32_t> last_stored_num()const;
+
          mutable std::fstream _blocks;
          mutable std::fstream _block_num_to_pos;
+         mutable mapped_file  _blocks_map;
+         mutable mapped_file  _index_map;
+         uint64_t             _blocks_size = 0;
+         uint64_t             _index_size = 0;
    };
 } }
@@ -30,11 +30,16 @@
 #include <graphene/chain/block_database.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
+#include <graphene/chain/signature_key_cache.hpp>
+#include <graphene/chain/state_checkpoint.hpp>
+#include <graphene/chain/witness_schedule_object.hpp>
+#include <graphene/chain/proposal_object.hpp>
 
 #include <graphene/db/object_database.hpp>
 #include <graphene/db/object.hpp>
 #include <graphene/db/simple_index.hpp>
 #include <fc/signals.hpp>
+#include <fc/thread/future.hpp>
 
 #include <fc/crypto/hash_ctr_rng.hpp>
 
@@ -44,11 +49,15 @@
 
 #include <map>
 
+namespace graphene { namespace utilities { class thread_pool; } }
+
 namespace graphene { namespace chain {
    using graphene::db::abstract_object;
    using graphene::db::object;
    class op_evaluator;
    class transaction_evaluation_state;
+   class bet_order_book_index;
+   class match_activity_index;
 
    struct budget_record;
 
@@ -113,6 +122,32 @@ namespace graphene { namespace chain {
          void wipe(const fc::path& data_dir, bool include_blocks);
          void close(bool rewind = true);
 
+         //////////////////// db_state_checkpoint.cpp ////////////////////
+
+         /**
+          * Every @p interval blocks the object state is captured, and once that block has become irreversible the
+          * capture is written to the state_checkpoint directory on a background thread.  Only indexes that changed
+          * since the previous checkpoint are rewritten.  0, the default, disables checkpoints.
+          *
+          * The capture serializes the changed indexes on the thread applying the block, so that block takes longer
+          * to apply by roughly the time it takes to save those indexes, which stalls block production on a witness.
+          * Indexes that change every block, such as the operation history, are saved in full every time.  The time
+          * and size are logged.  At most one capture is held at a time, and it stays in memory until its block is
+          * irreversible, so a checkpoint costs up to the serialized size of the object database in memory.
+          */
+         void set_state_checkpoint_interval( uint32_t interval ) { _state_checkpoint_interval = interval; }
+
+         /**
+          * This method may be called instead of @ref database::open after an unclean shutdown.  It loads the object
+          * state from the latest state checkpoint and replays the blocks after it from the block log.
+          * @return false if there is no usable checkpoint or it fails to load, in which case the object state is
+          * empty and the caller should replay the block log instead
+          */
+         bool open_from_state_checkpoint( const fc::path& data_dir );
+
+         /// Blocks until a checkpoint being written in the background, if any, is on disk
+         void wait_for_state_checkpoint();
+
          //////////////////// db_block.cpp ////////////////////
 
          /**
@@ -124,6 +159,9 @@ namespace graphene { namespace chain {
          block_id_type              get_block_id_for_num( uint32_t block_num )const;
          optional<signed_block>     fetch_block_by_id( const block_id_type& id )const;
          optional<signed_block>     fetch_block_by_number( uint32_t num )const;
+         /** @return the serialized block from the block log, or an invalid view if it is not stored there */
+         block_view                 fetch_block_view_by_id( const block_id_type& id )const;
+         block_view                 fetch_block_view_by_number( uint32_t num )const;
          const signed_transaction&  get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type> get_block_ids_on_fork(block_id_type head_of_fork) const;
 
@@ -139,6 +177,36 @@ namespace graphene { namespace chain {
        
          void check_tansaction_for_duplicated_operations(const signed_transaction& trx);
 
+         /**
+          * Recovers the signing keys of all transactions in the block that are not in the signature key cache yet
+          * on the signature recovery threads and adds them to the cache, so the following apply only needs to look
+          * them up.  Does nothing when no recovery threads are configured or when skip excludes signature checks.
+          *
+          * This waits for the worker threads, yielding the calling fc::thread, so it must only be called while the
+          * database is in a consistent state, i.e. before the block starts being applied.
+          */
+         void precompute_signature_keys( const signed_block& b, uint32_t skip = skip_nothing );
+
+         /**
+          * @return the public keys of the signatures on trx, taken from the signature key cache if available and
+          * recovered on the calling thread (and added to the cache) otherwise
+          */
+         flat_set<public_key_type> get_signature_keys( const signed_transaction& trx );
+
+         signature_key_cache_stats get_signature_key_cache_stats()const { return _signature_key_cache.get_stats(); }
+         void set_signature_key_cache_size( size_t max_size ) { _signature_key_cache.set_max_size( max_size ); }
+
+         /// Number of worker threads used to recover transaction signatures in parallel; 0 recovers them serially
+         void     set_signature_recovery_threads( uint32_t thread_count );
+         uint32_t get_signature_recovery_threads()const;
+
+         /// Number of worker threads that work out betting market group payouts in parallel; 0 settles serially
+         void     set_settlement_threads( uint32_t thread_count );
+         uint32_t get_settlement_threads()const;
+
+         /// Number of worker threads that deserialize and hash blocks ahead of reindex; 0 prepares them inline
+         void     set_reindex_threads( uint32_t thread_count ) { _reindex_threads = thread_count; }
+
          bool push_block( const signed_block& b, uint32_t skip = skip_nothing );
          processed_transaction push_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          bool _push_block( const signed_block& b );
@@ -204,21 +272,20 @@ namespace graphene { namespace chain {
          fc::signal<void(const signed_transaction&)>     on_pending_transaction;
 
          /**
-          *  Emitted After a block has been applied and committed.  The callback
-          *  should not yield and should execute quickly.
-          */
-         fc::signal<void(const vector<object_id_type>&, const flat_set<account_id_type>&)> new_objects;
-
-         /**
-          *  Emitted After a block has been applied and committed.  The callback
-          *  should not yield and should execute quickly.
+          *  Connect @p slot to new_objects, changed_objects and removed_objects.  The impacted accounts passed with
+          *  them are only computed while a slot connected with @p wants_accounts is connected; otherwise the sets
+          *  are passed empty.  The signals are private so that every slot is connected through these.
           */
-         fc::signal<void(const vector<object_id_type>&, const flat_set<account_id_type>&)> changed_objects;
-
-         /** this signal is emitted any time an object is removed and contains a
-          * pointer to the last value of every object that was removed.
-          */
-         fc::signal<void(const vector<object_id_type>&, const vector<const object*>&, const flat_set<account_id_type>&)>  removed_objects;
+         boost::signals2::connection connect_new_objects(
+               const std::function<void(const vector<object_id_type>&, const flat_set<account_id_type>&)>& slot,
+               bool wants_accounts );
+         boost::signals2::connection connect_changed_objects(
+               const std::function<void(const vector<object_id_type>&, const flat_set<account_id_type>&)>& slot,
+               bool wants_accounts );
+         boost::signals2::connection connect_removed_objects(
+               const std::function<void(const vector<object_id_type>&, const vector<const object*>&,
+                                        const flat_set<account_id_type>&)>& slot,
+               bool wants_accounts );
 
          //////////////////// db_witness_schedule.cpp ////////////////////
 
@@ -238,6 +305,12 @@ namespace graphene { namespace chain {
           */
          witness_id_type get_scheduled_witness(uint32_t slot_num)const;
 
+         /**
+          * Get the witnesses scheduled for count consecutive slots starting at first_slot,
+          * the same as calling get_scheduled_witness() for each of them, in one pass.
+          */
+         vector<witness_id_type> get_scheduled_witnesses(uint32_t first_slot, uint32_t count)const;
+
          /**
           * Get the time at which the given slot occurs.
           *
@@ -393,6 +466,14 @@ namespace graphene { namespace chain {
          void cancel_bet(const bet_object& bet, bool create_virtual_op = true);
          void cancel_all_unmatched_bets_on_betting_market(const betting_market_object& betting_market);
          void cancel_all_unmatched_bets_on_betting_market_group(const betting_market_group_object& betting_market_group);
+         /**
+          * @brief Visit the delayed bets of some betting markets in the order their delays end
+          * @param markets the betting markets whose delayed bets are visited
+          * @param ended_by if given, stop at the first bet whose delay ends after this time
+          * @param f called for each bet; it must place or cancel the bet, taking it out of the delayed bets
+          */
+         void for_each_delayed_bet(const flat_set<betting_market_id_type>& markets, optional<time_point_sec> ended_by,
+                                   const std::function<void(const bet_object&)>& f);
          void validate_betting_market_group_resolutions(const betting_market_group_object& betting_market_group,
                                                         const std::map<betting_market_id_type, betting_market_resolution_type>& resolutions);
          void resolve_betting_market_group(const betting_market_group_object& betting_market_group,
@@ -445,8 +526,28 @@ namespace graphene { namespace chain {
          //Mark pop_undo() as protected -- we do not want outside calling pop_undo(); it should call pop_block() instead
          void pop_undo() { object_database::pop_undo(); }
          void notify_changed_objects();
+         void notify_changed_objects( const undo_state& changes );
+         /// @return an object that counts as an impacted accounts listener while it lives, or null
+         std::shared_ptr<void> impacted_accounts_listener( bool wants_accounts );
 
       private:
+         /**
+          *  Emitted After a block has been applied and committed.  The callback
+          *  should not yield and should execute quickly.
+          */
+         fc::signal<void(const vector<object_id_type>&, const flat_set<account_id_type>&)> new_objects;
+
+         /**
+          *  Emitted After a block has been applied and committed.  The callback
+          *  should not yield and should execute quickly.
+          */
+         fc::signal<void(const vector<object_id_type>&, const flat_set<account_id_type>&)> changed_objects;
+
+         /** this signal is emitted any time an object is removed and contains a
+          * pointer to the last value of every object that was removed.
+          */
+         fc::signal<void(const vector<object_id_type>&, const vector<const object*>&, const flat_set<account_id_type>&)>  removed_objects;
+
          optional<undo_database::session>       _pending_tx_session;
          vector< unique_ptr<op_evaluator> >     _operation_evaluators;
 
@@ -483,6 +584,7 @@ namespace graphene { namespace chain {
          void update_maintenance_flag( bool new_maintenance_flag );
          void update_withdraw_permissions();
          void update_tournaments();
+         void process_in_progress_tournaments();
          void update_betting_markets(fc::time_point_sec current_block_time);
          bool check_for_blackswan( const asset_object& mia, bool enable_black_swan = true );
 
@@ -505,8 +607,13 @@ namespace graphene { namespace chain {
          ///@}
 
          vector< processed_transaction >        _pending_tx;
+         proposed_operations_digest_counter     _pending_tx_digests;
          fork_database                          _fork_db;
 
+         signature_key_cache                    _signature_key_cache;
+         std::unique_ptr<graphene::utilities::thread_pool> _signature_recovery_pool;
+         std::unique_ptr<graphene::utilities::thread_pool> _settlement_pool;
+
          /**
           *  Note: we can probably store blocks by block num rather than
           *  block id because after the undo window is past the block ID
@@ -541,6 +648,32 @@ namespace graphene { namespace chain {
          node_property_object              _node_property_object;
          fc::hash_ctr_rng<secret_hash_type, 20> _random_number_generator;
          bool                              _slow_replays = false;
+         uint32_t                          _reindex_threads = 0;
+         /// the number of connected slots that want impacted accounts, shared with their connections
+         std::shared_ptr<uint32_t>         _impacted_accounts_listeners = std::make_shared<uint32_t>( 0 );
+         mutable far_future_schedule_cache _far_future_schedule;
+         const bet_order_book_index*       _bet_order_book = nullptr;
+         match_activity_index*             _match_activity = nullptr;
+         const proposed_operations_digest_index* _proposed_operations_digests = nullptr;
+
+         /// the far future schedule wso leads to, rebuilt only when wso has changed since the last call
+         const far_future_witness_scheduler& get_far_future_scheduler( const witness_schedule_object& wso )const;
+
+         void replay_blocks( uint32_t first_block_num, uint32_t last_block_num );
+
+         void update_state_checkpoint();
+         std::unique_ptr<state_checkpoint_capture> capture_state_checkpoint();
+         void write_state_checkpoint( std::unique_ptr<state_checkpoint_capture> capture );
+         void reset_state_checkpoints( const fc::path& data_dir );
+
+         uint32_t                                   _state_checkpoint_interval = 0;
+         fc::path                                   _state_checkpoint_dir;
+         uint64_t                                   _state_checkpoint_generation = 0;
+         /// (space, type) -> (file, index revision) of the index files named by the latest checkpoint
+         std::map< std::pair<uint8_t,uint8_t>, std::pair<state_checkpoint_file,uint64_t> > _state_checkpoint_files;
+         std::unique_ptr<state_checkpoint_capture>  _pending_state_checkpoint;
+         std::unique_ptr<graphene::utilities::thread_pool> _state_checkpoint_writer;
+         fc::future<void>                           _state_checkpoint_write;
    };
 
    namespace detail
@@ -104,6 +104,35 @@ namespace graphene { namespace chain {
    > match_object_multi_index_type;
    typedef generic_index<match_object, match_object_multi_index_type> match_index;
 
+   /**
+    * @class match_activity_index
+    * @brief remembers the tournaments whose matches were created, changed or removed since they were last checked
+    *
+    * A tournament's next matches can only become ready to start when one of its matches changes, so only these
+    * tournaments need to be checked for new matches to start.  Undoing a change to a match and loading a match
+    * at startup both mark its tournament too.
+    */
+   class match_activity_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_restored( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void object_modified( const object& after ) override;
+
+         /// @return the tournaments marked since the last call, leaving none marked
+         std::set<tournament_id_type> take_active_tournaments();
+         /// forget the marks the given tournaments got since they were taken
+         void unmark( const std::set<tournament_id_type>& tournaments );
+         /// @return the tournaments marked since they were last taken
+         const std::set<tournament_id_type>& active_tournaments()const { return _active_tournaments; }
+
+      private:
+         void mark( const object& obj );
+
+         std::set<tournament_id_type> _active_tournaments;
+   };
+
    template<typename Stream>
    inline Stream& operator<<( Stream& s, const match_object& match_obj )
    { 
@@ -28,6 +28,8 @@
 
 #include <graphene/db/generic_index.hpp>
 
+#include <unordered_map>
+
 namespace graphene { namespace chain {
 
 
@@ -79,6 +81,58 @@ class required_approval_index : public secondary_index
       map<account_id_type, set<proposal_id_type> > _account_to_proposals;
 };
 
+/**
+ *  @return the digests of the operations proposed by the proposal_create operations in trx
+ */
+std::vector<fc::sha256> gather_proposed_operations_digests( const transaction& trx );
+
+/**
+ *  @brief counts the proposed operation digests of a set of transactions, so that a
+ *  duplicate can be found with a hash lookup instead of re-digesting every transaction
+ */
+class proposed_operations_digest_counter
+{
+   public:
+      void add( const transaction& trx );
+      void remove( const transaction& trx );
+      void clear() { _counts.clear(); }
+
+      bool contains( const fc::sha256& digest )const { return _counts.find( digest ) != _counts.end(); }
+      size_t size()const { return _counts.size(); }
+
+   private:
+      struct digest_hash
+      {
+         size_t operator()( const fc::sha256& digest )const { return size_t( digest._hash[0] ); }
+      };
+
+      std::unordered_map<fc::sha256, uint32_t, digest_hash> _counts;
+};
+
+/**
+ *  @brief tracks the operations proposed by nested proposal_create operations of all
+ *  open proposals
+ *
+ *  @ingroup object
+ *  @ingroup protocol
+ *
+ *  This is a secondary index on the proposal_index
+ *
+ *  @note the proposed transaction is constant
+ */
+class proposed_operations_digest_index : public secondary_index
+{
+   public:
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_restored( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+
+      const proposed_operations_digest_counter& digests()const { return _digests; }
+
+   private:
+      proposed_operations_digest_counter _digests;
+};
+
 struct by_expiration{};
 typedef boost::multi_index_container<
    proposal_object,
@@ -41,14 +41,34 @@ namespace graphene { namespace chain {
       static uint32_t num_from_id(const block_id_type& id);
    };
 
+   /**
+    *  The id, digest and signee of a header are memoized.  Each cached value remembers the header
+    *  contents it was derived from and is recomputed as soon as any field differs, so callers may
+    *  keep mutating a header between calls.  The cache is not reflected and does not affect
+    *  serialization.  Concurrent first calls on the same object from several threads are not safe.
+    */
    struct signed_block_header : public block_header
    {
       block_id_type              id()const;
+      digest_type                digest()const;
       fc::ecc::public_key        signee()const;
       void                       sign( const fc::ecc::private_key& signer );
       bool                       validate_signee( const fc::ecc::public_key& expected_signee )const;
 
       signature_type             witness_signature;
+
+   private:
+      bool                       cache_is_current()const;
+      void                       refresh_cache()const;
+
+      mutable block_header          _cached_header;
+      mutable signature_type        _cached_signature;
+      mutable block_id_type         _cached_id;
+      mutable digest_type           _cached_digest;
+      mutable fc::ecc::public_key   _cached_signee;
+      mutable bool                  _has_cached_id = false;
+      mutable bool                  _has_cached_digest = false;
+      mutable bool                  _has_cached_signee = false;
    };
 
    struct signed_block : public signed_block_header
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/protocol/types.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+
+namespace graphene { namespace chain {
+
+   struct signature_key_cache_stats
+   {
+      uint64_t size = 0;
+      uint64_t max_size = 0;
+      /// number of lookups answered from the cache
+      uint64_t hits = 0;
+      /// number of transactions whose signatures had to be recovered
+      uint64_t misses = 0;
+   };
+
+   /**
+    * @class signature_key_cache
+    * @brief bounded cache of the public keys recovered from transaction signatures
+    *
+    * Entries are keyed on the transaction's signature digest, which covers the chain id and the unsigned
+    * transaction, and also record the signatures they were recovered from, so a transaction with the same body but
+    * different signatures never hits a stale entry.  When the cache is full the least recently used entry is evicted.
+    *
+    * This lets a transaction be recovered once when it enters the pending pool and reuse the result when it is
+    * re-applied by generate_block(), pushed back after pop_block() or received again inside a block.
+    */
+   class signature_key_cache
+   {
+      public:
+         explicit signature_key_cache( size_t max_size = 20000 ) : _max_size( max_size ) {}
+
+         /** @return the cached keys of the transaction or nullptr, counting a hit if found */
+         const flat_set<public_key_type>* find( const digest_type& sig_digest, const vector<signature_type>& signatures );
+         /** @return true if the keys of the transaction are cached, without touching the statistics */
+         bool contains( const digest_type& sig_digest, const vector<signature_type>& signatures )const;
+         /** add freshly recovered keys, counting a miss */
+         void insert( const digest_type& sig_digest, const vector<signature_type>& signatures, flat_set<public_key_type> keys );
+
+         void set_max_size( size_t max_size );
+         void clear() { _entries.clear(); }
+
+         signature_key_cache_stats get_stats()const;
+
+      private:
+         struct entry
+         {
+            digest_type               sig_digest;
+            vector<signature_type>    signatures;
+            flat_set<public_key_type> keys;
+         };
+         struct by_digest;
+         typedef boost::multi_index_container<
+            entry,
+            boost::multi_index::indexed_by<
+               boost::multi_index::sequenced<>,
+               boost::multi_index::ordered_unique< boost::multi_index::tag<by_digest>,
+                  boost::multi_index::member< entry, digest_type, &entry::sig_digest > >
+            >
+         > entry_index_type;
+
+         entry_index_type _entries;
+         size_t           _max_size;
+         uint64_t         _hits = 0;
+         uint64_t         _misses = 0;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::signature_key_cache_stats, (size)(max_size)(hits)(misses) )
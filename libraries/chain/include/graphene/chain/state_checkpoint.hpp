@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/chain/protocol/types.hpp>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace graphene { namespace chain {
+
+   /** one index file of a state checkpoint */
+   struct state_checkpoint_file
+   {
+      uint8_t     space = 0;
+      uint8_t     type = 0;
+      std::string file;
+      /// checked before loading, a file cut short by a crash is not used
+      uint64_t    size = 0;
+   };
+
+   /**
+    *  Describes the object state at an irreversible block.  Stored as "manifest" in the checkpoint
+    *  directory; it is replaced atomically after all files it names have been written.
+    */
+   struct state_checkpoint_manifest
+   {
+      uint64_t                           generation = 0;
+      uint32_t                           block_num = 0;
+      block_id_type                      block_id;
+      std::vector<state_checkpoint_file> indexes;
+   };
+
+   /**
+    *  Object state serialized when a checkpoint block was applied.  It is kept in memory until that
+    *  block becomes irreversible and is then written out by the checkpoint thread.
+    */
+   struct state_checkpoint_capture
+   {
+      state_checkpoint_manifest manifest;
+      /// index files that changed since the previous checkpoint, with their serialized content
+      std::vector< std::pair< std::string, std::shared_ptr<std::stringstream> > > files;
+      /// (space, type) -> (file, index revision) for the files above
+      std::vector< std::pair< std::pair<uint8_t,uint8_t>, std::pair<state_checkpoint_file,uint64_t> > > revisions;
+      /// total size of the files above, i.e. the memory held by this capture
+      uint64_t bytes = 0;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::state_checkpoint_file, (space)(type)(file)(size) )
+FC_REFLECT( graphene::chain::state_checkpoint_manifest, (generation)(block_num)(block_id)(indexes) )
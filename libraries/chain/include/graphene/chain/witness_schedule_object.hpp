@@ -73,6 +73,17 @@ class witness_schedule_object : public graphene::db::abstract_object<witness_sch
       fc::uint128 recent_slots_filled;
 };
 
+/**
+ * The far future schedule that a witness_schedule_object leads to, kept by the database between lookups
+ * together with a digest of the scheduler state and rng seed it was built from.  The far future schedule
+ * repeats itself, so once built it answers every slot until the witness_schedule_object changes.
+ */
+struct far_future_schedule_cache
+{
+   fc::sha256                                  state_digest;
+   fc::optional< far_future_witness_scheduler > scheduler;
+};
+
 } }
 
 
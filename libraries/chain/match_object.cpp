@@ -360,6 +360,45 @@ namespace graphene { namespace chain {
    }
 #endif
 
+   void match_activity_index::mark( const object& obj )
+   {
+      assert( dynamic_cast<const match_object*>(&obj) ); // for debug only
+      _active_tournaments.insert( static_cast<const match_object&>(obj).tournament_id );
+   }
+
+   void match_activity_index::object_inserted( const object& obj )
+   {
+      mark( obj );
+   }
+
+   void match_activity_index::object_restored( const object& obj )
+   {
+      mark( obj );
+   }
+
+   void match_activity_index::object_removed( const object& obj )
+   {
+      mark( obj );
+   }
+
+   void match_activity_index::object_modified( const object& after )
+   {
+      mark( after );
+   }
+
+   std::set<tournament_id_type> match_activity_index::take_active_tournaments()
+   {
+      std::set<tournament_id_type> result;
+      result.swap( _active_tournaments );
+      return result;
+   }
+
+   void match_activity_index::unmark( const std::set<tournament_id_type>& tournaments )
+   {
+      for( const tournament_id_type& tournament_id : tournaments )
+         _active_tournaments.erase( tournament_id );
+   }
+
 } } // graphene::chain
 
 namespace fc { 
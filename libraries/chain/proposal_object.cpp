@@ -24,6 +24,9 @@
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
+#include <graphene/chain/protocol/betting_market.hpp>
+
+#include <fc/crypto/digest.hpp>
 
 namespace graphene { namespace chain {
 
@@ -92,4 +95,77 @@ void required_approval_index::object_removed( const object& obj )
        remove( a, p.id );
 }
 
+namespace {
+
+   struct proposed_operations_digest_accumulator
+   {
+      typedef void result_type;
+
+      void operator()(const proposal_create_operation& proposal)
+      {
+         for (auto& operation: proposal.proposed_ops)
+         {
+            proposed_operations_digests.push_back(fc::digest(operation.op));
+         }
+      }
+
+      //empty template method is needed for all other operation types
+      //we can ignore them, we are interested in only proposal_create_operation
+      template<class T>
+      void operator()(const T&)
+      {}
+
+      std::vector<fc::sha256> proposed_operations_digests;
+   };
+
+}
+
+std::vector<fc::sha256> gather_proposed_operations_digests( const transaction& trx )
+{
+   proposed_operations_digest_accumulator digest_accumulator;
+
+   for (auto& op: trx.operations)
+   {
+      if( op.which() != operation::tag<betting_market_group_create_operation>::value
+       && op.which() != operation::tag<betting_market_create_operation>::value )
+         op.visit(digest_accumulator);
+   }
+
+   return digest_accumulator.proposed_operations_digests;
+}
+
+void proposed_operations_digest_counter::add( const transaction& trx )
+{
+   for( const auto& digest : gather_proposed_operations_digests( trx ) )
+      ++_counts[digest];
+}
+
+void proposed_operations_digest_counter::remove( const transaction& trx )
+{
+   for( const auto& digest : gather_proposed_operations_digests( trx ) )
+   {
+      auto itr = _counts.find( digest );
+      assert( itr != _counts.end() );
+      if( itr != _counts.end() && --itr->second == 0 )
+         _counts.erase( itr );
+   }
+}
+
+void proposed_operations_digest_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const proposal_object*>(&obj) );
+   _digests.add( static_cast<const proposal_object&>(obj).proposed_transaction );
+}
+
+void proposed_operations_digest_index::object_restored( const object& obj )
+{
+   object_inserted( obj );
+}
+
+void proposed_operations_digest_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const proposal_object*>(&obj) );
+   _digests.remove( static_cast<const proposal_object&>(obj).proposed_transaction );
+}
+
 } } // graphene::chain
@@ -37,19 +37,66 @@ namespace graphene { namespace chain {
       return fc::endian_reverse_u32(id._hash[0]);
    }
 
+   bool signed_block_header::cache_is_current()const
+   {
+      // extensions can only hold void_t today, so equal sizes imply equal contents
+      return _cached_header.previous == previous
+          && _cached_header.timestamp == timestamp
+          && _cached_header.witness == witness
+          && _cached_header.next_secret_hash == next_secret_hash
+          && _cached_header.previous_secret == previous_secret
+          && _cached_header.transaction_merkle_root == transaction_merkle_root
+          && _cached_header.extensions.size() == extensions.size()
+          && _cached_signature == witness_signature;
+   }
+
+   void signed_block_header::refresh_cache()const
+   {
+      if( cache_is_current() )
+         return;
+      _cached_header = static_cast<const block_header&>(*this);
+      _cached_signature = witness_signature;
+      _has_cached_id = false;
+      _has_cached_digest = false;
+      _has_cached_signee = false;
+   }
+
+   digest_type signed_block_header::digest()const
+   {
+      refresh_cache();
+      if( !_has_cached_digest )
+      {
+         _cached_digest = block_header::digest();
+         _has_cached_digest = true;
+      }
+      return _cached_digest;
+   }
+
    block_id_type signed_block_header::id()const
    {
+      refresh_cache();
+      if( _has_cached_id )
+         return _cached_id;
+
       auto tmp = fc::sha224::hash( *this );
       tmp._hash[0] = fc::endian_reverse_u32(block_num()); // store the block num in the ID, 160 bits is plenty for the hash
       static_assert( sizeof(tmp._hash[0]) == 4, "should be 4 bytes" );
       block_id_type result;
       memcpy(result._hash, tmp._hash, std::min(sizeof(result), sizeof(tmp)));
+      _cached_id = result;
+      _has_cached_id = true;
       return result;
    }
 
    fc::ecc::public_key signed_block_header::signee()const
    {
-      return fc::ecc::public_key( witness_signature, digest(), true/*enforce canonical*/ );
+      refresh_cache();
+      if( !_has_cached_signee )
+      {
+         _cached_signee = fc::ecc::public_key( witness_signature, digest(), true/*enforce canonical*/ );
+         _has_cached_signee = true;
+      }
+      return _cached_signee;
    }
 
    void signed_block_header::sign( const fc::ecc::private_key& signer )
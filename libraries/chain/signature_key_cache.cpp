@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/signature_key_cache.hpp>
+
+namespace graphene { namespace chain {
+
+const flat_set<public_key_type>* signature_key_cache::find( const digest_type& sig_digest, const vector<signature_type>& signatures )
+{
+   const auto& by_digest_idx = _entries.get<by_digest>();
+   auto itr = by_digest_idx.find( sig_digest );
+   if( itr == by_digest_idx.end() || itr->signatures != signatures )
+      return nullptr;
+   ++_hits;
+   // move to the back of the eviction order
+   _entries.relocate( _entries.end(), _entries.project<0>( itr ) );
+   return &itr->keys;
+}
+
+bool signature_key_cache::contains( const digest_type& sig_digest, const vector<signature_type>& signatures )const
+{
+   const auto& by_digest_idx = _entries.get<by_digest>();
+   auto itr = by_digest_idx.find( sig_digest );
+   return itr != by_digest_idx.end() && itr->signatures == signatures;
+}
+
+void signature_key_cache::insert( const digest_type& sig_digest, const vector<signature_type>& signatures, flat_set<public_key_type> keys )
+{
+   ++_misses;
+   if( _max_size == 0 )
+      return;
+
+   auto& by_digest_idx = _entries.get<by_digest>();
+   auto itr = by_digest_idx.find( sig_digest );
+   if( itr != by_digest_idx.end() )
+      by_digest_idx.erase( itr );
+
+   entry e;
+   e.sig_digest = sig_digest;
+   e.signatures = signatures;
+   e.keys = std::move( keys );
+   _entries.push_back( std::move( e ) );
+
+   while( _entries.size() > _max_size )
+      _entries.pop_front();
+}
+
+void signature_key_cache::set_max_size( size_t max_size )
+{
+   _max_size = max_size;
+   while( _entries.size() > _max_size )
+      _entries.pop_front();
+}
+
+signature_key_cache_stats signature_key_cache::get_stats()const
+{
+   signature_key_cache_stats result;
+   result.size = _entries.size();
+   result.max_size = _max_size;
+   result.hits = _hits;
+   result.misses = _misses;
+   return result;
+}
+
+} } // graphene::chain
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/db/change_journal.hpp>
+
+namespace graphene { namespace db {
+
+void change_journal::on_create( const object& obj )
+{
+   if( !_enabled ) return;
+   _changes.new_ids.insert( obj.id );
+}
+
+void change_journal::on_modify( const object& obj )
+{
+   if( !_enabled ) return;
+   if( _changes.new_ids.find( obj.id ) != _changes.new_ids.end() )
+      return;
+   if( _changes.old_values.find( obj.id ) != _changes.old_values.end() )
+      return;
+   _changes.old_values[obj.id] = _pool.copy( obj );
+}
+
+void change_journal::on_remove( const object& obj )
+{
+   if( !_enabled ) return;
+   if( _changes.new_ids.erase( obj.id ) )
+      return;
+   auto itr = _changes.old_values.find( obj.id );
+   if( itr != _changes.old_values.end() )
+   {
+      _changes.removed[obj.id] = std::move( itr->second );
+      _changes.old_values.erase( itr );
+      return;
+   }
+   if( _changes.removed.count( obj.id ) ) return;
+   _changes.removed[obj.id] = _pool.copy( obj );
+}
+
+bool change_journal::empty()const
+{
+   return _changes.new_ids.empty() && _changes.old_values.empty() && _changes.removed.empty();
+}
+
+void change_journal::clear()
+{
+   _pool.recycle( _changes );
+   _changes.clear();
+}
+
+} } // graphene::db
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/db/undo_database.hpp>
+
+namespace graphene { namespace db {
+
+   /**
+    * @class change_journal
+    * @brief records which objects were created, modified and removed, independently of the undo history
+    *
+    * When the undo database is disabled, e.g. while replaying blocks with apply_block(), nothing is left
+    * to tell observers which objects a block touched.  The journal keeps the same information as a single
+    * undo_state - created ids, the first old value of every modified object and the old value of every
+    * removed object - but has no sessions and can't be undone.  The owner reads it after each block and
+    * clears it.
+    */
+   class change_journal
+   {
+      public:
+         void enable()  { _enabled = true; }
+         void disable() { _enabled = false; clear(); }
+         bool enabled()const { return _enabled; }
+
+         void on_create( const object& obj );
+         void on_modify( const object& obj );
+         void on_remove( const object& obj );
+
+         /** the changes recorded since the last clear() */
+         const undo_state& changes()const { return _changes; }
+         bool              empty()const;
+         /** forget the recorded changes, keeping the copies for reuse */
+         void              clear();
+
+      private:
+         bool             _enabled = false;
+         undo_state       _changes;
+         undo_object_pool _pool;
+   };
+
+} } // graphene::db
@@ -27,12 +27,34 @@
 #include <fc/io/raw.hpp>
 #include <fc/io/json.hpp>
 #include <fc/crypto/sha256.hpp>
+#include <fc/optional.hpp>
 #include <fstream>
+#include <utility>
 
 namespace graphene { namespace db {
    class object_database;
    using fc::path;
 
+   /**
+    *  Header at the start of every index file written by primary_index::save().  All fields have a fixed
+    *  size when packed, so the header can be rewritten in place once the object count is known.  The
+    *  magic number uses object space 255, which no index can have, so it can never be mistaken for the
+    *  next_id that starts a file in the legacy format.
+    */
+   struct index_file_header
+   {
+      static const uint64_t magic_value    = 0xff47444249445832ULL;
+      static const uint32_t current_format = 2;
+
+      uint64_t       magic          = magic_value;
+      uint32_t       format_version = current_format;
+      object_id_type next_id;
+      fc::sha256     object_version;
+      uint64_t       object_count   = 0;
+      /** number of bytes of packed objects that follow the header */
+      uint64_t       data_size      = 0;
+   };
+
    /**
     * @class index_observer
     * @brief used to get callbacks when objects change
@@ -95,6 +117,28 @@ namespace graphene { namespace db {
           */
          virtual void open( const fc::path& db ) = 0;
          virtual void save( const fc::path& db ) = 0;
+         /** writes the same content as save( const fc::path& ) to a stream, which must support seekp */
+         virtual void save( std::ostream& out )const = 0;
+
+         /**
+          *  A counter that changes whenever the objects or the next id of this index change, including
+          *  changes made while undoing.  It starts over when the process restarts.
+          */
+         virtual uint64_t get_revision()const = 0;
+
+         /**
+          *  open() split in two so that object_database can read several indexes concurrently:
+          *  prepare_open() deserializes the file without touching the index and may run on any thread,
+          *  finish_open() inserts the objects it read and must run on the database thread.
+          */
+         virtual void prepare_open( const fc::path& db ) = 0;
+         virtual void finish_open() = 0;
+
+         /**
+          *  Drops every object and resets the next id without saving undo state or notifying observers,
+          *  so that the index can be loaded again after a failed load.
+          */
+         virtual void clear() = 0;
 
 
 
@@ -139,6 +183,11 @@ namespace graphene { namespace db {
       public:
          virtual ~secondary_index(){};
          virtual void object_inserted( const object& obj ){};
+         /**
+          *  called after insert() put an object back into the index, which is how the undo database restores
+          *  removed objects; object_inserted() is not called in that case
+          */
+         virtual void object_restored( const object& obj ){};
          virtual void object_removed( const object& obj ){};
          virtual void about_to_modify( const object& before ){};
          virtual void object_modified( const object& after  ){};
@@ -164,10 +213,10 @@ namespace graphene { namespace db {
          /** called just after obj is modified */
          void on_modify( const object& obj );
 
-         template<typename T>
-         T* add_secondary_index()
+         template<typename T, typename... Args>
+         T* add_secondary_index( Args&&... args )
          {
-            _sindex.emplace_back( new T() );
+            _sindex.emplace_back( new T( std::forward<Args>(args)... ) );
             return static_cast<T*>(_sindex.back().get());
          }
 
@@ -214,8 +263,10 @@ namespace graphene { namespace db {
          { return object_type::type_id; }
 
          virtual object_id_type get_next_id()const override              { return _next_id;    }
-         virtual void           use_next_id()override                    { ++_next_id.number;  }
-         virtual void           set_next_id( object_id_type id )override { _next_id = id;      }
+         virtual void           use_next_id()override                    { ++_next_id.number; ++_revision; }
+         virtual void           set_next_id( object_id_type id )override { _next_id = id; ++_revision;     }
+
+         virtual uint64_t get_revision()const override { return _revision; }
 
          fc::sha256 get_object_version()const
          {
@@ -224,24 +275,61 @@ namespace graphene { namespace db {
          }
 
          virtual void open( const path& db )override
-         { 
+         {
+            prepare_open( db );
+            finish_open();
+         }
+
+         virtual void prepare_open( const path& db )override
+         {
+            _loaded_objects.clear();
+            _loaded_next_id.reset();
             if( !fc::exists( db ) ) return;
+            const auto file_size = fc::file_size( db );
+            if( file_size == 0 ) return;
             fc::file_mapping fm( db.generic_string().c_str(), fc::read_only );
-            fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size(db) );
+            fc::mapped_region mr( fm, fc::read_only, 0, file_size );
             fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
-            fc::sha256 open_ver;
 
-            fc::raw::unpack(ds, _next_id);
-            fc::raw::unpack(ds, open_ver);
-            FC_ASSERT( open_ver == get_object_version(), "Incompatible Version, the serialization of objects in this index has changed" );
-            try {
-               vector<char> tmp;
-               while( true ) 
-               {
-                  fc::raw::unpack( ds, tmp );
-                  load( tmp );
-               }
-            } catch ( const fc::exception&  ){}
+            uint64_t magic = 0;
+            fc::datastream<const char*> peek( (const char*)mr.get_address(), mr.get_size() );
+            if( peek.remaining() >= sizeof(magic) )
+               fc::raw::unpack( peek, magic );
+            if( magic != index_file_header::magic_value )
+            {
+               prepare_open_legacy( ds );
+               return;
+            }
+
+            index_file_header header;
+            fc::raw::unpack( ds, header );
+            FC_ASSERT( header.format_version == index_file_header::current_format,
+                       "Unsupported index file format ${f}", ("f", header.format_version) );
+            FC_ASSERT( header.object_version == get_object_version(), "Incompatible Version, the serialization of objects in this index has changed" );
+            FC_ASSERT( header.data_size <= ds.remaining(), "Index file is truncated", ("file", db) );
+            // every packed object takes at least one byte, which bounds the allocation below
+            FC_ASSERT( header.object_count <= header.data_size, "Index file header is corrupt",
+                       ("file", db)("object_count", header.object_count)("data_size", header.data_size) );
+
+            // objects are unpacked straight out of the mapping, one after another
+            _loaded_objects.resize( header.object_count );
+            const auto data_end = ds.remaining() - header.data_size;
+            for( auto& obj : _loaded_objects )
+               fc::raw::unpack( ds, obj );
+            FC_ASSERT( ds.remaining() == data_end, "Index file size does not match its header", ("file", db) );
+            _loaded_next_id = header.next_id;
+         }
+
+         virtual void finish_open()override
+         {
+            if( _loaded_next_id.valid() )
+               _next_id = *_loaded_next_id;
+            ++_revision;
+            for( auto& obj : _loaded_objects )
+               insert_loaded( std::move(obj) );
+            _loaded_objects.clear();
+            _loaded_objects.shrink_to_fit();
+            _loaded_next_id.reset();
          }
 
          virtual void save( const path& db ) override 
@@ -249,27 +337,62 @@ namespace graphene { namespace db {
             std::ofstream out( db.generic_string(), 
                                std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
             FC_ASSERT( out );
-            auto ver  = get_object_version();
-            fc::raw::pack( out, _next_id );
-            fc::raw::pack( out, ver );
+            save( out );
+            out.flush();
+            FC_ASSERT( out, "Unable to write index file ${f}", ("f", db) );
+         }
+
+         virtual void save( std::ostream& out )const override
+         {
+            const auto header_start = out.tellp();
+            index_file_header header;
+            header.next_id = _next_id;
+            header.object_version = get_object_version();
+            fc::raw::pack( out, header );
+            const auto data_start = out.tellp();
             this->inspect_all_objects( [&]( const object& o ) {
-                auto vec = fc::raw::pack( static_cast<const object_type&>(o) );
-                auto packed_vec = fc::raw::pack( vec );
-                out.write( packed_vec.data(), packed_vec.size() );
+                fc::raw::pack( out, static_cast<const object_type&>(o) );
+                ++header.object_count;
             });
+            const auto data_end = out.tellp();
+            header.data_size = uint64_t( data_end - data_start );
+            out.seekp( header_start );
+            fc::raw::pack( out, header );
+            out.seekp( data_end );
+         }
+
+         virtual void clear()override
+         {
+            vector<const object*> objects;
+            DerivedIndex::inspect_all_objects( [&objects]( const object& obj ) { objects.push_back( &obj ); } );
+            for( const object* obj : objects )
+            {
+               for( const auto& item : _sindex )
+                  item->object_removed( *obj );
+               DerivedIndex::remove( *obj );
+            }
+            _next_id = object_id_type( object_type::space_id, object_type::type_id, 0 );
+            ++_revision;
          }
 
          virtual const object&  load( const std::vector<char>& data )override
          {
-            const auto& result = DerivedIndex::insert( fc::raw::unpack<object_type>( data ) );
+            return insert_loaded( fc::raw::unpack<object_type>( data ) );
+         }
+
+
+         virtual const object&  insert( object&& obj )override
+         {
+            ++_revision;
+            const auto& result = DerivedIndex::insert( std::move(obj) );
             for( const auto& item : _sindex )
-               item->object_inserted( result );
+               item->object_restored( result );
             return result;
          }
 
-
          virtual const object&  create(const std::function<void(object&)>& constructor )override
          {
+            ++_revision;
             const auto& result = DerivedIndex::create( constructor );
             for( const auto& item : _sindex )
                item->object_inserted( result );
@@ -279,6 +402,7 @@ namespace graphene { namespace db {
 
          virtual void  remove( const object& obj ) override
          {
+            ++_revision;
             for( const auto& item : _sindex )
                item->object_removed( obj );
             on_remove(obj);
@@ -287,6 +411,7 @@ namespace graphene { namespace db {
 
          virtual void modify( const object& obj, const std::function<void(object&)>& m )override
          {
+            ++_revision;
             save_undo( obj );
             for( const auto& item : _sindex )
                item->about_to_modify( obj );
@@ -320,7 +445,48 @@ namespace graphene { namespace db {
          }
 
       private:
-         object_id_type _next_id;
+         const object& insert_loaded( object_type&& obj )
+         {
+            ++_revision;
+            const auto& result = DerivedIndex::insert( std::move(obj) );
+            for( const auto& item : _sindex )
+               item->object_inserted( result );
+            return result;
+         }
+
+         /** reads files written before index_file_header existed: next_id, version, then size-prefixed objects */
+         void prepare_open_legacy( fc::datastream<const char*>& ds )
+         {
+            object_id_type next_id;
+            fc::sha256 open_ver;
+            fc::raw::unpack(ds, next_id);
+            fc::raw::unpack(ds, open_ver);
+            FC_ASSERT( open_ver == get_object_version(), "Incompatible Version, the serialization of objects in this index has changed" );
+            try {
+               while( ds.remaining() > 0 )
+               {
+                  fc::unsigned_int size;
+                  fc::raw::unpack( ds, size );
+                  FC_ASSERT( size.value <= ds.remaining() );
+                  const auto expected_remaining = ds.remaining() - size.value;
+                  object_type obj;
+                  fc::raw::unpack( ds, obj );
+                  FC_ASSERT( ds.remaining() == expected_remaining );
+                  _loaded_objects.push_back( std::move(obj) );
+               }
+            } catch ( const fc::exception& ) {
+               // like before, loading stops at the first object that cannot be read
+            }
+            _loaded_next_id = next_id;
+         }
+
+         object_id_type               _next_id;
+         vector<object_type>          _loaded_objects;
+         fc::optional<object_id_type> _loaded_next_id;
+         uint64_t                     _revision = 0;
    };
 
 } } // graphene::db
+
+FC_REFLECT( graphene::db::index_file_header,
+            (magic)(format_version)(next_id)(object_version)(object_count)(data_size) )
@@ -72,6 +72,7 @@ namespace graphene { namespace db {
 
          /// these methods are implemented for derived classes by inheriting abstract_object<DerivedClass>
          virtual unique_ptr<object> clone()const = 0;
+         virtual void               copy_from( const object& obj ) = 0;
          virtual void               move_from( object& obj ) = 0;
          virtual variant            to_variant()const  = 0;
          virtual vector<char>       pack()const = 0;
@@ -94,6 +95,15 @@ namespace graphene { namespace db {
             return unique_ptr<object>(new DerivedClass( *static_cast<const DerivedClass*>(this) ));
          }
 
+         /**
+          *  Assigns obj to this object in place; unlike clone() this reuses the heap storage
+          *  already owned by this object (vectors, strings, pimpl state) where possible.
+          */
+         virtual void    copy_from( const object& obj )
+         {
+            static_cast<DerivedClass&>(*this) = static_cast<const DerivedClass&>(obj);
+         }
+
          virtual void    move_from( object& obj )
          {
             static_cast<DerivedClass&>(*this) = std::move( static_cast<DerivedClass&>(obj) );
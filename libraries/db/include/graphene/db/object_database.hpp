@@ -25,6 +25,7 @@
 #include <graphene/db/object.hpp>
 #include <graphene/db/index.hpp>
 #include <graphene/db/undo_database.hpp>
+#include <graphene/db/change_journal.hpp>
 
 #include <fc/log/logger.hpp>
 
@@ -45,6 +46,15 @@ namespace graphene { namespace db {
          void reset_indexes() { _index.clear(); _index.resize(255); }
 
          void open(const fc::path& data_dir );
+         /**
+          *  Like open(), but loads each index from the file given for its (space, type) instead of from
+          *  data_dir.  Indexes without an entry start empty.
+          */
+         void open( const fc::path& data_dir, const std::map< std::pair<uint8_t,uint8_t>, fc::path >& index_files );
+
+         /// Number of threads that deserialize index files in parallel during open(); 0 reads them serially
+         void     set_load_threads( uint32_t thread_count ) { _load_threads = thread_count; }
+         uint32_t get_load_threads()const { return _load_threads; }
 
          /**
           * Saves the complete state of the object_database to disk, this could take a while
@@ -52,6 +62,10 @@ namespace graphene { namespace db {
          void flush();
          void wipe(const fc::path& data_dir); // remove from disk
          void close();
+         /// drops every object from memory, without undo state; used to recover from a failed open()
+         void clear();
+
+         void inspect_all_indexes( const std::function<void(const index&)>& inspector )const;
 
          template<typename T, typename F>
          const T& create( F&& constructor )
@@ -156,7 +170,11 @@ namespace graphene { namespace db {
          index& get_mutable_index(object_id_type id)  { return get_mutable_index(id.space(),id.type());   }
          index& get_mutable_index(uint8_t space_id, uint8_t type_id);
 
+         /** records changes for observers while the undo database is disabled; off unless enabled */
+         change_journal                         _change_journal;
+
      private:
+         void load_index_files( const vector< std::pair<index*, fc::path> >& to_open );
 
          friend class base_primary_index;
          friend class undo_database;
@@ -166,6 +184,7 @@ namespace graphene { namespace db {
 
          fc::path                                                  _data_dir;
          vector< vector< unique_ptr<index> > >                     _index;
+         uint32_t                                                  _load_threads = 0;
    };
 
 } } // graphene::db
@@ -24,6 +24,8 @@
 #pragma once
 #include <graphene/db/object.hpp>
 #include <deque>
+#include <unordered_map>
+#include <unordered_set>
 #include <fc/exception/exception.hpp>
 
 namespace graphene { namespace db {
@@ -32,12 +34,111 @@ namespace graphene { namespace db {
    using fc::flat_set;
    class object_database;
 
+   /**
+    * @class undo_node_allocator
+    * @brief allocator for the node based containers of an undo_state
+    *
+    * Undo states are created and torn down for every pending transaction, so their hash containers allocate and
+    * free a node for every object touched.  Single node allocations are served from a per-type, per-thread free
+    * list instead of the heap; nodes released when a session is merged, undone or dropped are reused by the next
+    * session.  The free list only ever grows to the peak number of live nodes.  Bulk allocations (bucket arrays)
+    * go to the global heap.
+    */
+   template<typename T>
+   class undo_node_allocator
+   {
+      public:
+         typedef T value_type;
+         template<typename U> struct rebind { typedef undo_node_allocator<U> other; };
+
+         undo_node_allocator(){}
+         template<typename U> undo_node_allocator( const undo_node_allocator<U>& ){}
+
+         T* allocate( std::size_t n )
+         {
+            if( n != 1 )
+               return static_cast<T*>( ::operator new( n * sizeof(T) ) );
+            free_node*& head = free_list();
+            if( head == nullptr )
+               return static_cast<T*>( ::operator new( node_size ) );
+            free_node* node = head;
+            head = node->next;
+            return reinterpret_cast<T*>( node );
+         }
+
+         void deallocate( T* p, std::size_t n )
+         {
+            if( n != 1 )
+               return ::operator delete( p );
+            free_node*& head = free_list();
+            free_node* node = reinterpret_cast<free_node*>( p );
+            node->next = head;
+            head = node;
+         }
+
+         template<typename U> bool operator == ( const undo_node_allocator<U>& )const { return true;  }
+         template<typename U> bool operator != ( const undo_node_allocator<U>& )const { return false; }
+
+      private:
+         struct free_node { free_node* next; };
+         static const std::size_t node_size = sizeof(T) > sizeof(free_node) ? sizeof(T) : sizeof(free_node);
+
+         static free_node*& free_list()
+         {
+            static thread_local free_node* head = nullptr;
+            return head;
+         }
+   };
+
+   template<typename K, typename V>
+   using undo_map = std::unordered_map< K, V, std::hash<K>, std::equal_to<K>, undo_node_allocator< std::pair<const K, V> > >;
+   template<typename K>
+   using undo_set = std::unordered_set< K, std::hash<K>, std::equal_to<K>, undo_node_allocator<K> >;
+
    struct undo_state
    {
-      unordered_map<object_id_type, unique_ptr<object> > old_values;
-      unordered_map<object_id_type, object_id_type>      old_index_next_ids;
-      std::unordered_set<object_id_type>                 new_ids;
-      unordered_map<object_id_type, unique_ptr<object> > removed;
+      undo_map<object_id_type, unique_ptr<object> > old_values;
+      undo_map<object_id_type, object_id_type>      old_index_next_ids;
+      undo_set<object_id_type>                      new_ids;
+      undo_map<object_id_type, unique_ptr<object> > removed;
+
+      /** empties the state but keeps the bucket arrays so the state can be reused by another session */
+      void clear()
+      {
+         old_values.clear();
+         old_index_next_ids.clear();
+         new_ids.clear();
+         removed.clear();
+      }
+   };
+
+   /**
+    * @class undo_object_pool
+    * @brief recycles the object copies used as undo pre-images
+    *
+    * Every first modification of an object within an undo session stores a copy of the object.  Rather than
+    * allocating a fresh copy with clone() and freeing it again when the session is committed, merged or undone,
+    * discarded copies are kept here per object type and overwritten in place with copy_from() the next time an
+    * object of the same type needs to be saved.
+    */
+   class undo_object_pool
+   {
+      public:
+         /** @return a copy of obj, reusing a pooled object of the same type if one is available */
+         unique_ptr<object> copy( const object& obj );
+         /** return a no longer needed copy to the pool; it is freed if the pool for its type is full */
+         void               recycle( unique_ptr<object>&& obj );
+         void               recycle( undo_state& state );
+
+         void     set_max_size_per_type( size_t s ) { _max_size_per_type = s; }
+         uint64_t hits()const   { return _hits;   }
+         uint64_t misses()const { return _misses; }
+
+      private:
+         unordered_map<uint16_t, vector< unique_ptr<object> > > _free;
+         size_t                                                 _max_size_per_type = 1024;
+         uint64_t                                               _hits = 0;
+         uint64_t                                               _misses = 0;
    };
 
 
@@ -132,16 +233,29 @@ namespace graphene { namespace db {
 
          const undo_state& head()const;
 
+         const undo_object_pool& object_pool()const { return _pool; }
+         undo_object_pool&       object_pool()      { return _pool; }
+
       private:
          void undo();
          void merge();
          void commit();
 
+         /** pushes an empty state, reusing a previously released one if possible */
+         void push_state();
+         /** removes the newest / oldest state, keeping its containers for reuse */
+         void pop_state_back();
+         void pop_state_front();
+         void release_state( undo_state& state );
+
          uint32_t                _active_sessions = 0;
          bool                    _disabled = true;
          std::deque<undo_state>  _stack;
+         /** released states whose (empty) containers are reused by push_state() */
+         std::deque<undo_state>  _spare_states;
          object_database&        _db;
          size_t                  _max_size = 256;
+         undo_object_pool        _pool;
    };
 
 } } // graphene::db
@@ -23,6 +23,8 @@
  */
 #include <graphene/db/object_database.hpp>
 
+#include <graphene/utilities/thread_pool.hpp>
+
 #include <fc/io/raw.hpp>
 #include <fc/container/flat.hpp>
 #include <fc/uint128.hpp>
@@ -42,6 +44,15 @@ void object_database::close()
 {
 }
 
+void object_database::clear()
+{
+   // in reverse order of loading, secondary indexes may refer to objects of the indexes loaded before theirs
+   for( auto space = _index.rbegin(); space != _index.rend(); ++space )
+      for( auto idx = space->rbegin(); idx != space->rend(); ++idx )
+         if( *idx )
+            (*idx)->clear();
+}
+
 const object* object_database::find_object( object_id_type id )const
 {
    return get_index(id.space(),id.type()).find( id );
@@ -89,18 +100,86 @@ void object_database::wipe(const fc::path& data_dir)
    ilog("Done wiping object databse.");
 }
 
+void object_database::inspect_all_indexes( const std::function<void(const index&)>& inspector )const
+{
+   for( const auto& space : _index )
+      for( const auto& idx : space )
+         if( idx )
+            inspector( *idx );
+}
+
 void object_database::open(const fc::path& data_dir)
 { try {
    ilog("Opening object database from ${d} ...", ("d", data_dir));
    _data_dir = data_dir;
+
+   vector< std::pair<index*, fc::path> > to_open;
    for( uint32_t space = 0; space < _index.size(); ++space )
       for( uint32_t type = 0; type  < _index[space].size(); ++type )
          if( _index[space][type] )
-            _index[space][type]->open( _data_dir / "object_database" / fc::to_string(space)/fc::to_string(type) );
-   ilog( "Done opening object database." );
+            to_open.emplace_back( _index[space][type].get(),
+                                  _data_dir / "object_database" / fc::to_string(space)/fc::to_string(type) );
+   load_index_files( to_open );
 
 } FC_CAPTURE_AND_RETHROW( (data_dir) ) }
 
+void object_database::open( const fc::path& data_dir, const std::map< std::pair<uint8_t,uint8_t>, fc::path >& index_files )
+{ try {
+   ilog("Opening object database from ${n} index files ...", ("n", index_files.size()));
+   _data_dir = data_dir;
+
+   vector< std::pair<index*, fc::path> > to_open;
+   for( uint32_t space = 0; space < _index.size(); ++space )
+      for( uint32_t type = 0; type  < _index[space].size(); ++type )
+      {
+         auto file = index_files.find( std::make_pair( uint8_t(space), uint8_t(type) ) );
+         if( _index[space][type] && file != index_files.end() )
+            to_open.emplace_back( _index[space][type].get(), file->second );
+      }
+   load_index_files( to_open );
+
+} FC_CAPTURE_AND_RETHROW( (data_dir) ) }
+
+void object_database::load_index_files( const vector< std::pair<index*, fc::path> >& to_open )
+{
+   auto start = fc::time_point::now();
+   if( _load_threads == 0 )
+   {
+      for( const auto& item : to_open )
+         item.first->open( item.second );
+   }
+   else
+   {
+      // Files are deserialized on the pool, but inserted on this thread in the original order
+      // because secondary indexes may create objects in other indexes as objects are loaded.
+      graphene::utilities::thread_pool pool( "object_db_load", _load_threads );
+      vector< fc::future<void> > prepared;
+      prepared.reserve( to_open.size() );
+      for( const auto& item : to_open )
+      {
+         index* idx = item.first;
+         fc::path file = item.second;
+         prepared.push_back( pool.async( [idx, file]() { idx->prepare_open( file ); }, "prepare_open" ) );
+      }
+
+      fc::optional<fc::exception> except;
+      for( size_t i = 0; i < prepared.size(); ++i )
+      {
+         try {
+            prepared[i].wait();
+            if( !except )
+               to_open[i].first->finish_open();
+         } catch( const fc::exception& e ) {
+            if( !except )
+               except = e;
+         }
+      }
+      if( except )
+         throw *except;
+   }
+   ilog( "Done opening object database in ${t} ms.", ("t", (fc::time_point::now() - start).count() / 1000) );
+}
+
 
 void object_database::pop_undo()
 { try {
@@ -110,16 +189,19 @@ void object_database::pop_undo()
 void object_database::save_undo( const object& obj )
 {
    _undo_db.on_modify( obj );
+   _change_journal.on_modify( obj );
 }
 
 void object_database::save_undo_add( const object& obj )
 {
    _undo_db.on_create( obj );
+   _change_journal.on_create( obj );
 }
 
 void object_database::save_undo_remove(const object& obj)
 {
    _undo_db.on_remove( obj );
+   _change_journal.on_remove( obj );
 }
 
 } } // namespace graphene::db
@@ -27,6 +27,39 @@
 
 namespace graphene { namespace db {
 
+unique_ptr<object> undo_object_pool::copy( const object& obj )
+{
+   auto itr = _free.find( obj.id.space_type() );
+   if( itr == _free.end() || itr->second.empty() )
+   {
+      ++_misses;
+      return obj.clone();
+   }
+   ++_hits;
+   unique_ptr<object> result = std::move( itr->second.back() );
+   itr->second.pop_back();
+   result->copy_from( obj );
+   return result;
+}
+
+void undo_object_pool::recycle( unique_ptr<object>&& obj )
+{
+   if( !obj ) return;
+   auto& free_list = _free[ obj->id.space_type() ];
+   if( free_list.size() < _max_size_per_type )
+      free_list.emplace_back( std::move(obj) );
+   else
+      obj.reset();
+}
+
+void undo_object_pool::recycle( undo_state& state )
+{
+   for( auto& item : state.old_values )
+      recycle( std::move(item.second) );
+   for( auto& item : state.removed )
+      recycle( std::move(item.second) );
+}
+
 void undo_database::enable()  { _disabled = false; }
 void undo_database::disable() { _disabled = true; }
 
@@ -38,9 +71,9 @@ undo_database::session undo_database::start_undo_session( bool force_enable )
       _disabled = false;
 
    while( size() > max_size() )
-      _stack.pop_front();
+      pop_state_front();
 
-   _stack.emplace_back();
+   push_state();
    ++_active_sessions;
    return session(*this, disable_on_exit );
 }
@@ -49,7 +82,7 @@ void undo_database::on_create( const object& obj )
    if( _disabled ) return;
 
    if( _stack.empty() )
-      _stack.emplace_back();
+      push_state();
    auto& state = _stack.back();
    auto index_id = object_id_type( obj.id.space(), obj.id.type(), 0 );
    auto itr = state.old_index_next_ids.find( index_id );
@@ -62,20 +95,20 @@ void undo_database::on_modify( const object& obj )
    if( _disabled ) return;
 
    if( _stack.empty() )
-      _stack.emplace_back();
+      push_state();
    auto& state = _stack.back();
    if( state.new_ids.find(obj.id) != state.new_ids.end() )
       return;
    auto itr =  state.old_values.find(obj.id);
    if( itr != state.old_values.end() ) return;
-   state.old_values[obj.id] = obj.clone();
+   state.old_values[obj.id] = _pool.copy( obj );
 }
 void undo_database::on_remove( const object& obj )
 {
    if( _disabled ) return;
 
    if( _stack.empty() )
-      _stack.emplace_back();
+      push_state();
    undo_state& state = _stack.back();
    if( state.new_ids.count(obj.id) )
    {
@@ -89,7 +122,7 @@ void undo_database::on_remove( const object& obj )
       return;
    }
    if( state.removed.count(obj.id) ) return;
-   state.removed[obj.id] = obj.clone();
+   state.removed[obj.id] = _pool.copy( obj );
 }
 
 void undo_database::undo()
@@ -117,9 +150,9 @@ void undo_database::undo()
    for( auto& item : state.removed )
       _db.insert( std::move(*item.second) );
 
-   _stack.pop_back();
+   pop_state_back();
    if( _stack.empty() )
-      _stack.emplace_back();
+      push_state();
    enable();
    --_active_sessions;
 } FC_CAPTURE_AND_RETHROW() }
@@ -235,7 +268,9 @@ void undo_database::merge()
       // nop + del(was=Y) -> del(was=Y)
       prev_state.removed[obj.second->id] = std::move(obj.second);
    }
-   _stack.pop_back();
+
+   // whatever was not moved into prev_state above (the type A cases) is no longer needed
+   pop_state_back();
    --_active_sessions;
 }
 void undo_database::commit()
@@ -271,7 +306,7 @@ void undo_database::pop_commit()
       for( auto& item : state.removed )
          _db.insert( std::move(*item.second) );
 
-      _stack.pop_back();
+      pop_state_back();
    }
    catch ( const fc::exception& e )
    {
@@ -281,6 +316,38 @@ void undo_database::pop_commit()
    }
    enable();
 }
+void undo_database::push_state()
+{
+   if( _spare_states.empty() )
+   {
+      _stack.emplace_back();
+      return;
+   }
+   _stack.emplace_back( std::move( _spare_states.back() ) );
+   _spare_states.pop_back();
+}
+
+void undo_database::pop_state_back()
+{
+   release_state( _stack.back() );
+   _stack.pop_back();
+}
+
+void undo_database::pop_state_front()
+{
+   release_state( _stack.front() );
+   _stack.pop_front();
+}
+
+void undo_database::release_state( undo_state& state )
+{
+   _pool.recycle( state );
+   state.clear();
+   // keep a few states around; the stack rarely grows more than a couple of sessions past its steady size
+   if( _spare_states.size() < 16 )
+      _spare_states.emplace_back( std::move( state ) );
+}
+
 const undo_state& undo_database::head()const
 {
    FC_ASSERT( !_stack.empty() );
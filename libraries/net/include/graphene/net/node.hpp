@@ -291,6 +291,12 @@ namespace graphene { namespace net {
         std::vector<potential_peer_record> get_potential_peers() const;
 
         void disable_peer_advertising();
+
+        /**
+         * Sets the number of threads that unpack and hash the blocks and transactions received from peers,
+         * 0 to do it on the p2p thread.  Messages of the same peer are still handled in the order they arrived.
+         */
+        void set_message_decoding_threads( uint32_t thread_count );
         fc::variant_object get_call_statistics() const;
       private:
         std::unique_ptr<detail::node_impl, detail::node_impl_deleter> my;
@@ -78,6 +78,8 @@
 #include <graphene/net/config.hpp>
 #include <graphene/net/exceptions.hpp>
 
+#include <graphene/utilities/thread_pool.hpp>
+
 #include <graphene/chain/config.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 
@@ -578,6 +580,9 @@ namespace graphene { namespace net { namespace detail {
 
       std::list<fc::future<void> > _handle_message_calls_in_progress;
 
+      /// unpacks and hashes incoming blocks and transactions, so that peers being synced from in parallel are decoded in parallel
+      std::unique_ptr<graphene::utilities::thread_pool> _message_decoding_pool;
+
       node_impl(const std::string& user_agent);
       virtual ~node_impl();
 
@@ -621,6 +626,17 @@ namespace graphene { namespace net { namespace detail {
       fc::variant_object generate_hello_user_data();
       void parse_hello_user_data_for_peer( peer_connection* originating_peer, const fc::variant_object& user_data );
 
+      /// the parts of a received message that are worked out before it is handled
+      struct decoded_message
+      {
+        message_hash_type                            message_hash;
+        fc::optional<graphene::net::block_message>   block;
+        fc::optional<graphene::net::trx_message>     transaction;
+      };
+      /// pure function of the message, safe to call on any thread; hashes the message unless its hash is given
+      static decoded_message decode_message( const message& received_message,
+                                             const fc::optional<message_hash_type>& message_hash = fc::optional<message_hash_type>() );
+
       void on_message( peer_connection* originating_peer,
                        const message& received_message ) override;
 
@@ -684,9 +700,9 @@ namespace graphene { namespace net { namespace detail {
       void trigger_process_backlog_of_sync_blocks();
       void process_block_during_sync(peer_connection* originating_peer, const graphene::net::block_message& block_message, const message_hash_type& message_hash);
       void process_block_during_normal_operation(peer_connection* originating_peer, const graphene::net::block_message& block_message, const message_hash_type& message_hash);
-      void process_block_message(peer_connection* originating_peer, const message& message_to_process, const message_hash_type& message_hash);
+      void process_block_message(peer_connection* originating_peer, const graphene::net::block_message& block_message_to_process, const message_hash_type& message_hash);
 
-      void process_ordinary_message(peer_connection* originating_peer, const message& message_to_process, const message_hash_type& message_hash);
+      void process_ordinary_message(peer_connection* originating_peer, const message& message_to_process, const decoded_message& decoded);
 
       void start_synchronizing();
       void start_synchronizing_with_peer(const peer_connection_ptr& peer);
@@ -749,6 +765,7 @@ namespace graphene { namespace net { namespace detail {
       void                       clear_peer_database();
       void                       set_total_bandwidth_limit( uint32_t upload_bytes_per_second, uint32_t download_bytes_per_second );
       void                       disable_peer_advertising();
+      void                       set_message_decoding_threads( uint32_t thread_count );
       fc::variant_object         get_call_statistics() const;
       message                    get_message_for_item(const item_id& item) override;
 
@@ -1756,10 +1773,50 @@ namespace graphene { namespace net { namespace detail {
       }
     }
 
+    node_impl::decoded_message node_impl::decode_message( const message& received_message,
+                                                          const fc::optional<message_hash_type>& message_hash )
+    {
+      decoded_message decoded;
+      decoded.message_hash = message_hash.valid() ? *message_hash : received_message.id();
+      if( received_message.msg_type == core_message_type_enum::block_message_type )
+        decoded.block = received_message.as<graphene::net::block_message>();
+      else if( received_message.msg_type == trx_message_type )
+        decoded.transaction = received_message.as<trx_message>();
+      return decoded;
+    }
+
     void node_impl::on_message( peer_connection* originating_peer, const message& received_message )
     {
       VERIFY_CORRECT_THREAD();
-      message_hash_type message_hash = received_message.id();
+      // a transaction we did not ask for only gets its peer disconnected by process_ordinary_message, so it is
+      // checked before anything is unpacked or queued on the decoding pool
+      fc::optional<message_hash_type> known_hash;
+      bool unpack = true;
+      if( received_message.msg_type == trx_message_type )
+      {
+        known_hash = received_message.id();
+        unpack = originating_peer->items_requested_from_peer.find( item_id( trx_message_type, *known_hash ) ) !=
+                 originating_peer->items_requested_from_peer.end();
+      }
+
+      decoded_message decoded;
+      if( !unpack )
+        decoded.message_hash = *known_hash;
+      else if( _message_decoding_pool &&
+               ( received_message.msg_type == core_message_type_enum::block_message_type ||
+                 received_message.msg_type == trx_message_type ) )
+      {
+        // this peer's read loop waits for us, so its messages are still handled in the order they arrived, while
+        // the p2p thread goes on with the messages of other peers.  The message is copied into the task because
+        // the wait may be canceled before the task has finished with it.
+        message message_to_decode( received_message );
+        decoded = _message_decoding_pool->async( [message_to_decode, known_hash]() {
+                                                    return decode_message( message_to_decode, known_hash );
+                                                 }, "decode p2p message" ).wait();
+      }
+      else
+        decoded = decode_message( received_message, known_hash );
+      const message_hash_type& message_hash = decoded.message_hash;
       dlog("handling message ${type} ${hash} size ${size} from peer ${endpoint}",
            ("type", graphene::net::core_message_type_enum(received_message.msg_type))("hash", message_hash)
            ("size", received_message.size)
@@ -1800,7 +1857,7 @@ namespace graphene { namespace net { namespace detail {
         on_closing_connection_message(originating_peer, received_message.as<closing_connection_message>());
         break;
       case core_message_type_enum::block_message_type:
-        process_block_message(originating_peer, received_message, message_hash);
+        process_block_message(originating_peer, *decoded.block, message_hash);
         break;
       case core_message_type_enum::current_time_request_message_type:
         on_current_time_request_message(originating_peer, received_message.as<current_time_request_message>());
@@ -1826,7 +1883,7 @@ namespace graphene { namespace net { namespace detail {
         // to allow us to add messages in the future
         if (received_message.msg_type < core_message_type_enum::core_message_type_first ||
             received_message.msg_type > core_message_type_enum::core_message_type_last)
-          process_ordinary_message(originating_peer, received_message, message_hash);
+          process_ordinary_message(originating_peer, received_message, decoded);
         break;
       }
     }
@@ -3520,7 +3577,7 @@ namespace graphene { namespace net { namespace detail {
       }
     }
     void node_impl::process_block_message(peer_connection* originating_peer,
-                                          const message& message_to_process,
+                                          const graphene::net::block_message& block_message_to_process,
                                           const message_hash_type& message_hash)
     {
       VERIFY_CORRECT_THREAD();
@@ -3528,7 +3585,6 @@ namespace graphene { namespace net { namespace detail {
       // (it's possible that we request an item during normal operation and then get kicked into sync
       // mode before we receive and process the item.  In that case, we should process the item as a normal
       // item to avoid confusing the sync code)
-      graphene::net::block_message block_message_to_process(message_to_process.as<graphene::net::block_message>());
       auto item_iter = originating_peer->items_requested_from_peer.find(item_id(graphene::net::block_message_type, message_hash));
       if (item_iter != originating_peer->items_requested_from_peer.end())
       {
@@ -3864,9 +3920,10 @@ namespace graphene { namespace net { namespace detail {
     // this just passes the message to the client, and does the bookkeeping
     // related to requesting and rebroadcasting the message.
     void node_impl::process_ordinary_message( peer_connection* originating_peer,
-                                              const message& message_to_process, const message_hash_type& message_hash )
+                                              const message& message_to_process, const decoded_message& decoded )
     {
       VERIFY_CORRECT_THREAD();
+      const message_hash_type& message_hash = decoded.message_hash;
       fc::time_point message_receive_time = fc::time_point::now();
 
       // only process it if we asked for it
@@ -3892,7 +3949,7 @@ namespace graphene { namespace net { namespace detail {
         {
           if (message_to_process.msg_type == trx_message_type)
           {
-            trx_message transaction_message_to_process = message_to_process.as<trx_message>();
+            const trx_message& transaction_message_to_process = *decoded.transaction;
             dlog("passing message containing transaction ${trx} to client", ("trx", transaction_message_to_process.trx.id()));
             _delegate->handle_transaction(transaction_message_to_process);
           }
@@ -5076,6 +5133,15 @@ namespace graphene { namespace net { namespace detail {
       _rate_limiter.set_download_limit( download_bytes_per_second );
     }
 
+    void node_impl::set_message_decoding_threads( uint32_t thread_count )
+    {
+      VERIFY_CORRECT_THREAD();
+      if( thread_count > 0 )
+        _message_decoding_pool.reset( new graphene::utilities::thread_pool( "p2p message decoding", thread_count ) );
+      else
+        _message_decoding_pool.reset();
+    }
+
     void node_impl::disable_peer_advertising()
     {
       VERIFY_CORRECT_THREAD();
@@ -5291,6 +5357,11 @@ namespace graphene { namespace net { namespace detail {
     INVOKE_IN_IMPL(disable_peer_advertising);
   }
 
+  void node::set_message_decoding_threads( uint32_t thread_count )
+  {
+    INVOKE_IN_IMPL(set_message_decoding_threads, thread_count);
+  }
+
   fc::variant_object node::get_call_statistics() const
   {
     INVOKE_IN_IMPL(get_call_statistics);
@@ -67,6 +67,7 @@ class account_history_plugin_impl
       bool _partial_operations = false;
       primary_index< simple_index< operation_history_object > >* _oho_index;
       uint32_t _max_ops_per_account = -1;
+      operation_type_history_index* _operation_type_history = nullptr;
    private:
       /** add one history record, then check and remove the earliest history record */
       void add_account_history( const account_id_type account_id, const operation_history_id_type op_id );
@@ -235,8 +236,136 @@ void account_history_plugin_impl::add_account_history( const account_id_type acc
    }
 }
 
+/** collects the operations in [begin, itr) from the end, skipping those after max_sequence */
+template<typename Iterator>
+static void collect_history_backwards( Iterator begin, Iterator itr, uint32_t max_sequence,
+                                       uint32_t limit, vector<operation_history_id_type>& result )
+{
+   while( itr != begin && result.size() < limit )
+   {
+      --itr;
+      if( itr->sequence <= max_sequence )
+         result.push_back( itr->operation_id );
+   }
+}
+
 } // end namespace detail
 
+static operation_type_history_index::entry make_entry( const account_transaction_history_object& history )
+{
+   operation_type_history_index::entry e;
+   e.history = history.id;
+   e.account = history.account;
+   e.sequence = history.sequence;
+   e.operation_id = history.operation_id;
+   return e;
+}
+
+void operation_type_history_index::object_inserted( const object& obj )
+{
+   const auto& history = static_cast<const account_transaction_history_object&>( obj );
+   entry e = make_entry( history );
+   // a new history object always follows its operation, and operations are loaded before account histories
+   const operation_history_object* op = _db.find( history.operation_id );
+   if( op == nullptr )
+   {
+      _unresolved[e.history] = e;
+      return;
+   }
+   e.operation_type = op->op.which();
+   e.block_num = op->block_num;
+   _entries.insert( e );
+}
+
+void operation_type_history_index::object_restored( const object& obj )
+{
+   // the operation may still be waiting to be restored by the same undo, so it is looked up later
+   entry e = make_entry( static_cast<const account_transaction_history_object&>( obj ) );
+   _unresolved[e.history] = e;
+}
+
+void operation_type_history_index::object_removed( const object& obj )
+{
+   const account_transaction_history_id_type id( obj.id );
+   _entries.get<by_history>().erase( id );
+   _unresolved.erase( id );
+}
+
+void operation_type_history_index::index_unresolved()const
+{
+   for( auto itr = _unresolved.begin(); itr != _unresolved.end(); )
+   {
+      const operation_history_object* op = _db.find( itr->second.operation_id );
+      if( op == nullptr )
+      {
+         wlog( "account history ${h} refers to missing operation ${o}",
+               ("h", itr->second.history)("o", itr->second.operation_id) );
+         ++itr;
+         continue;
+      }
+      entry e = itr->second;
+      e.operation_type = op->op.which();
+      e.block_num = op->block_num;
+      _entries.insert( e );
+      itr = _unresolved.erase( itr );
+   }
+}
+
+const operation_type_history_index::entry_multi_index_type& operation_type_history_index::entries()const
+{
+   index_unresolved();
+   return _entries;
+}
+
+vector<operation_history_id_type> operation_type_history_index::find_by_sequence( account_id_type account,
+                                                                                   int32_t operation_type,
+                                                                                   uint32_t max_sequence,
+                                                                                   operation_history_id_type stop,
+                                                                                   uint32_t limit )const
+{
+   index_unresolved();
+   vector<operation_history_id_type> result;
+   const auto& by_seq_idx = _entries.get<by_type_seq>();
+   auto begin = by_seq_idx.lower_bound( boost::make_tuple( account, operation_type ) );
+   auto itr = by_seq_idx.upper_bound( boost::make_tuple( account, operation_type, max_sequence ) );
+   while( itr != begin && result.size() < limit )
+   {
+      --itr;
+      if( itr->operation_id.instance.value <= stop.instance.value )
+         break;
+      result.push_back( itr->operation_id );
+   }
+   return result;
+}
+
+vector<operation_history_id_type> operation_type_history_index::find_by_block( account_id_type account,
+                                                                                int32_t operation_type,
+                                                                                uint32_t first_block,
+                                                                                uint32_t end_block,
+                                                                                uint32_t max_sequence,
+                                                                                uint32_t limit )const
+{
+   index_unresolved();
+   vector<operation_history_id_type> result;
+   if( first_block >= end_block )
+      return result;
+   if( operation_type < 0 )
+   {
+      const auto& by_block_idx = _entries.get<by_block>();
+      detail::collect_history_backwards( by_block_idx.lower_bound( boost::make_tuple( account, first_block ) ),
+                                         by_block_idx.lower_bound( boost::make_tuple( account, end_block ) ),
+                                         max_sequence, limit, result );
+   }
+   else
+   {
+      const auto& by_block_idx = _entries.get<by_type_block>();
+      detail::collect_history_backwards( by_block_idx.lower_bound( boost::make_tuple( account, operation_type, first_block ) ),
+                                         by_block_idx.lower_bound( boost::make_tuple( account, operation_type, end_block ) ),
+                                         max_sequence, limit, result );
+   }
+   return result;
+}
+
 
 
 
@@ -265,6 +394,7 @@ void account_history_plugin::plugin_set_program_options(
          ("track-account", boost::program_options::value<std::vector<std::string>>()->composing()->multitoken(), "Account ID to track history for (may specify multiple times)")
          ("partial-operations", boost::program_options::value<bool>(), "Keep only those operations in memory that are related to account history tracking")
          ("max-ops-per-account", boost::program_options::value<uint32_t>(), "Maximum number of operations per account will be kept in memory")
+         ("index-history-by-operation-type", boost::program_options::value<bool>(), "Index account history by operation type and block, for typed and time range history queries")
          ;
    cfg.add(cli);
 }
@@ -273,7 +403,9 @@ void account_history_plugin::plugin_initialize(const boost::program_options::var
 {
    database().applied_block.connect( [&]( const signed_block& b){ my->update_account_histories(b); } );
    my->_oho_index = database().add_index< primary_index< simple_index< operation_history_object > > >();
-   database().add_index< primary_index< account_transaction_history_index > >();
+   auto ath_index = database().add_index< primary_index< account_transaction_history_index > >();
+   if( options.count("index-history-by-operation-type") && options["index-history-by-operation-type"].as<bool>() )
+      my->_operation_type_history = ath_index->add_secondary_index<operation_type_history_index>( database() );
 
    LOAD_VALUE_SET(options, "track-account", my->_tracked_accounts, graphene::chain::account_id_type);
    if (options.count("partial-operations")) {
@@ -293,4 +425,9 @@ flat_set<account_id_type> account_history_plugin::tracked_accounts() const
    return my->_tracked_accounts;
 }
 
+const operation_type_history_index* account_history_plugin::operation_type_history() const
+{
+   return my->_operation_type_history;
+}
+
 } }
@@ -30,6 +30,8 @@
 
 #include <fc/thread/future.hpp>
 
+#include <map>
+
 namespace graphene { namespace account_history {
    using namespace chain;
    //using namespace graphene::db;
@@ -62,6 +64,8 @@ namespace detail
     class account_history_plugin_impl;
 }
 
+class operation_type_history_index;
+
 class account_history_plugin : public graphene::app::plugin
 {
    public:
@@ -77,6 +81,9 @@ class account_history_plugin : public graphene::app::plugin
 
       flat_set<account_id_type> tracked_accounts()const;
 
+      /// @return the history by operation type, or nullptr unless index-history-by-operation-type is set
+      const operation_type_history_index* operation_type_history()const;
+
       friend class detail::account_history_plugin_impl;
       std::unique_ptr<detail::account_history_plugin_impl> my;
 };
@@ -92,6 +99,96 @@ class affiliate_reward_index : public secondary_index
       map<account_id_type, set<operation_history_id_type> > _history_by_account;
 };
 
+/**
+ *  Indexes the account_transaction_history_objects by the type and block of their operations, so that
+ *  the history of one operation type or of one time range is a range scan rather than a walk of the
+ *  whole linked list of an account.
+ */
+class operation_type_history_index : public secondary_index
+{
+   public:
+      struct entry
+      {
+         account_transaction_history_id_type history;
+         account_id_type                     account;
+         int32_t                             operation_type = 0;
+         uint32_t                            sequence = 0;
+         uint32_t                            block_num = 0;
+         operation_history_id_type           operation_id;
+      };
+
+      struct by_history;
+      struct by_type_seq;
+      struct by_type_block;
+      struct by_block;
+      typedef multi_index_container<
+         entry,
+         indexed_by<
+            ordered_unique< tag<by_history>, member< entry, account_transaction_history_id_type, &entry::history > >,
+            ordered_unique< tag<by_type_seq>,
+               composite_key< entry,
+                  member< entry, account_id_type, &entry::account >,
+                  member< entry, int32_t, &entry::operation_type >,
+                  member< entry, uint32_t, &entry::sequence >
+               >
+            >,
+            ordered_unique< tag<by_type_block>,
+               composite_key< entry,
+                  member< entry, account_id_type, &entry::account >,
+                  member< entry, int32_t, &entry::operation_type >,
+                  member< entry, uint32_t, &entry::block_num >,
+                  member< entry, uint32_t, &entry::sequence >
+               >
+            >,
+            ordered_unique< tag<by_block>,
+               composite_key< entry,
+                  member< entry, account_id_type, &entry::account >,
+                  member< entry, uint32_t, &entry::block_num >,
+                  member< entry, uint32_t, &entry::sequence >
+               >
+            >
+         >
+      > entry_multi_index_type;
+
+      operation_type_history_index( const database& db ) : _db( db ) {}
+
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_restored( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+
+      /**
+       *  @return the operations of account with operation_type, most recent first, that have a sequence
+       *  of at most max_sequence and an ID greater than stop
+       */
+      vector<operation_history_id_type> find_by_sequence( account_id_type account, int32_t operation_type,
+                                                          uint32_t max_sequence, operation_history_id_type stop,
+                                                          uint32_t limit )const;
+
+      /**
+       *  @return the operations of account in blocks [first_block, end_block), most recent first, that have a
+       *  sequence of at most max_sequence; a negative operation_type matches every operation
+       */
+      vector<operation_history_id_type> find_by_block( account_id_type account, int32_t operation_type,
+                                                       uint32_t first_block, uint32_t end_block,
+                                                       uint32_t max_sequence, uint32_t limit )const;
+
+      const entry_multi_index_type& entries()const;
+
+   private:
+      /// indexes the entries whose operation was not there yet when their history object came back
+      void index_unresolved()const;
+
+      const database&        _db;
+      // both are only completed lazily, by index_unresolved(), which the const queries call
+      mutable entry_multi_index_type _entries;
+      /**
+       *  The undo database restores removed objects in no particular order, so a restored history object may
+       *  come back before the operation it refers to.  Restored entries wait here, keyed by history ID, until
+       *  the next query looks their operation up.
+       */
+      mutable std::map< account_transaction_history_id_type, entry > _unresolved;
+};
+
 } } //graphene::account_history
 
 /*struct by_id;
@@ -25,6 +25,7 @@
 #include <fc/optional.hpp>
 #include <fc/variant_object.hpp>
 #include <fc/smart_ref_impl.hpp>
+#include <fc/thread/thread.hpp>
 
 #include <graphene/app/application.hpp>
 
@@ -44,19 +45,33 @@ namespace graphene { namespace bookie {
 
 namespace detail {
 
-class bookie_api_impl
+class bookie_api_impl : public std::enable_shared_from_this<bookie_api_impl>
 {
    public:
       bookie_api_impl(graphene::app::application& _app);
 
       binned_order_book get_binned_order_book(graphene::chain::betting_market_id_type betting_market_id, int32_t precision);
+      void subscribe_to_binned_order_book(std::function<void(const variant&)> callback,
+                                          graphene::chain::betting_market_id_type betting_market_id, int32_t precision);
+      void unsubscribe_from_binned_order_book(graphene::chain::betting_market_id_type betting_market_id, int32_t precision);
+      void on_binned_order_books_changed(const flat_set<betting_market_id_type>& markets);
       std::shared_ptr<graphene::bookie::bookie_plugin> get_plugin();
       asset get_total_matched_bet_amount_for_betting_market_group(betting_market_group_id_type group_id);
       std::vector<event_object> get_events_containing_sub_string(const std::string& sub_string, const std::string& language);
+      std::vector<event_object> get_events_with_name_containing(const std::string& sub_string, const std::string& language, uint32_t limit);
+      std::vector<event_object> get_events_with_name_starting_with(const std::string& prefix, const std::string& language, uint32_t limit);
       fc::variants get_objects(const vector<object_id_type>& ids) const;
       std::vector<matched_bet_object> get_matched_bets_for_bettor(account_id_type bettor_id) const;
       std::vector<matched_bet_object> get_all_matched_bets_for_bettor(account_id_type bettor_id, bet_id_type start, unsigned limit) const;
       graphene::app::application& app;
+
+      struct binned_order_book_subscription
+      {
+         std::function<void(const variant&)> callback;
+         binned_order_book                   last_sent;
+      };
+      std::map<std::pair<betting_market_id_type, int32_t>, binned_order_book_subscription> _binned_order_book_subscriptions;
+      boost::signals2::scoped_connection                                                    _binned_order_books_changed_connection;
 };
 
 bookie_api_impl::bookie_api_impl(graphene::app::application& _app) : app(_app)
@@ -65,85 +80,89 @@ bookie_api_impl::bookie_api_impl(graphene::app::application& _app) : app(_app)
 
 binned_order_book bookie_api_impl::get_binned_order_book(graphene::chain::betting_market_id_type betting_market_id, int32_t precision)
 {
-    std::shared_ptr<graphene::chain::database> db = app.chain_database();
-    const auto& bet_odds_idx = db->get_index_type<graphene::chain::bet_object_index>().indices().get<graphene::chain::by_odds>();
-    const chain_parameters& current_params = db->get_global_properties().parameters;
-
-    graphene::chain::bet_multiplier_type bin_size = GRAPHENE_BETTING_ODDS_PRECISION;
-    if (precision > 0)
-        for (int32_t i = 0; i < precision; ++i) {
-            FC_ASSERT(bin_size > (GRAPHENE_BETTING_MIN_MULTIPLIER - GRAPHENE_BETTING_ODDS_PRECISION), "invalid precision");
-            bin_size /= 10;
-        }
-    else if (precision < 0)
-        for (int32_t i = 0; i > precision; --i) {
-            FC_ASSERT(bin_size < (GRAPHENE_BETTING_MAX_MULTIPLIER - GRAPHENE_BETTING_ODDS_PRECISION), "invalid precision");
-            bin_size *= 10;
-        }
+    return get_plugin()->get_binned_order_book(betting_market_id, precision);
+}
 
-    binned_order_book result; 
+void bookie_api_impl::subscribe_to_binned_order_book(std::function<void(const variant&)> callback,
+                                                     graphene::chain::betting_market_id_type betting_market_id, int32_t precision)
+{
+    std::shared_ptr<graphene::bookie::bookie_plugin> plugin = get_plugin();
+    binned_order_book_subscription& subscription = _binned_order_book_subscriptions[std::make_pair(betting_market_id, precision)];
+    subscription.callback = callback;
+    subscription.last_sent = plugin->get_binned_order_book(betting_market_id, precision);
+    if (!_binned_order_books_changed_connection.connected())
+        _binned_order_books_changed_connection = plugin->binned_order_books_changed.connect(
+            [this](const flat_set<betting_market_id_type>& markets) { on_binned_order_books_changed(markets); });
+}
 
-    // use a bet_object here for convenience. we really only use it to track the amount, odds, and back_or_lay
-    fc::optional<bet_object> current_bin;
+void bookie_api_impl::unsubscribe_from_binned_order_book(graphene::chain::betting_market_id_type betting_market_id, int32_t precision)
+{
+    _binned_order_book_subscriptions.erase(std::make_pair(betting_market_id, precision));
+    if (_binned_order_book_subscriptions.empty())
+        _binned_order_books_changed_connection.disconnect();
+}
 
-    auto flush_current_bin = [&current_bin, &result]()
+namespace
+{
+    /// appends to changed the bins of current whose amount differs from last_sent, and the bins current no longer has
+    void diff_order_bins(const std::vector<order_bin>& last_sent, const std::vector<order_bin>& current, std::vector<order_bin>& changed)
     {
-        if (current_bin) // do nothing if the current bin is empty
+        std::map<bet_multiplier_type, share_type> sent_amounts;
+        for (const order_bin& bin : last_sent)
+            sent_amounts[bin.backer_multiplier] = bin.amount_to_bet;
+        for (const order_bin& bin : current)
         {
-            order_bin current_order_bin;
-
-            current_order_bin.backer_multiplier = current_bin->backer_multiplier;
-            current_order_bin.amount_to_bet = current_bin->amount_to_bet.amount;
-            //idump((*current_bin)(current_order_bin));
-            if (current_bin->back_or_lay == bet_type::back)
-                result.aggregated_back_bets.emplace_back(std::move(current_order_bin));
-            else // current_bin is aggregating back positions
-                result.aggregated_lay_bets.emplace_back(std::move(current_order_bin));
-
-            current_bin.reset();
+            auto sent = sent_amounts.find(bin.backer_multiplier);
+            if (sent == sent_amounts.end() || sent->second != bin.amount_to_bet)
+                changed.push_back(bin);
+            if (sent != sent_amounts.end())
+                sent_amounts.erase(sent);
         }
-    };
-
-    // iterate through both sides of the order book (backs at increasing odds then lays at decreasing odds)
-    for (auto bet_odds_iter = bet_odds_idx.lower_bound(std::make_tuple(betting_market_id));
-         bet_odds_iter != bet_odds_idx.end() && betting_market_id == bet_odds_iter->betting_market_id;
-         ++bet_odds_iter)
-    {
-        if (current_bin && 
-            (bet_odds_iter->back_or_lay != current_bin->back_or_lay /* we have switched from back to lay bets */ ||
-             (bet_odds_iter->back_or_lay == bet_type::back ? bet_odds_iter->backer_multiplier > current_bin->backer_multiplier :
-                                                             bet_odds_iter->backer_multiplier < current_bin->backer_multiplier)))
-            flush_current_bin();
-
-        if (!current_bin)
+        for (const auto& emptied : sent_amounts)
         {
-            // if there is no current bin, create one appropriate for the bet we're processing
-            current_bin = graphene::chain::bet_object();
-
-            // for back bets, we want to group all bets with odds from 3.0001 to 4 into the "4" bin
-            // for lay bets, we want to group all bets with odds from 3 to 3.9999 into the "3" bin
-            if (bet_odds_iter->back_or_lay == bet_type::back)
-            {
-               current_bin->backer_multiplier = (bet_odds_iter->backer_multiplier + bin_size - 1) / bin_size * bin_size;
-               current_bin->backer_multiplier = std::min<graphene::chain::bet_multiplier_type>(current_bin->backer_multiplier, current_params.max_bet_multiplier());
-               current_bin->back_or_lay = bet_type::back;
-            }
-            else
-            {
-               current_bin->backer_multiplier = bet_odds_iter->backer_multiplier / bin_size * bin_size;
-               current_bin->backer_multiplier = std::max<graphene::chain::bet_multiplier_type>(current_bin->backer_multiplier, current_params.min_bet_multiplier());
-               current_bin->back_or_lay = bet_type::lay;
-            }
-
-            current_bin->amount_to_bet.amount = 0;
+            order_bin bin;
+            bin.backer_multiplier = emptied.first;
+            bin.amount_to_bet = 0;
+            changed.push_back(bin);
         }
+    }
+}
 
-        current_bin->amount_to_bet.amount += bet_odds_iter->amount_to_bet.amount;
+/** note: this method cannot yield because it is called in the middle of
+ * applying a block.
+ */
+void bookie_api_impl::on_binned_order_books_changed(const flat_set<betting_market_id_type>& markets)
+{
+    std::shared_ptr<graphene::bookie::bookie_plugin> plugin = get_plugin();
+    std::vector<binned_order_book_update> updates;
+    for (auto& item : _binned_order_book_subscriptions)
+    {
+        if (markets.find(item.first.first) == markets.end())
+            continue;
+
+        binned_order_book current = plugin->get_binned_order_book(item.first.first, item.first.second);
+        binned_order_book_update update;
+        update.betting_market_id = item.first.first;
+        update.precision = item.first.second;
+        diff_order_bins(item.second.last_sent.aggregated_back_bets, current.aggregated_back_bets, update.back_bins);
+        diff_order_bins(item.second.last_sent.aggregated_lay_bets, current.aggregated_lay_bets, update.lay_bins);
+        item.second.last_sent = std::move(current);
+        if (!update.back_bins.empty() || !update.lay_bins.empty())
+            updates.emplace_back(std::move(update));
     }
-    if (current_bin)
-        flush_current_bin();
+    if (updates.empty())
+        return;
 
-    return result;
+    /// we need to ensure the bookie_api is not deleted for the life of the async operation
+    auto capture_this = shared_from_this();
+    fc::async([this, capture_this, updates](){
+        for (const binned_order_book_update& update : updates)
+        {
+            auto itr = _binned_order_book_subscriptions.find(std::make_pair(update.betting_market_id, update.precision));
+            if (itr != _binned_order_book_subscriptions.end())
+                itr->second.callback(fc::variant(update));
+        }
+    });
 }
 
 fc::variants bookie_api_impl::get_objects(const vector<object_id_type>& ids) const
@@ -273,6 +292,18 @@ std::vector<event_object> bookie_api_impl::get_events_containing_sub_string(cons
    return get_plugin()->get_events_containing_sub_string(sub_string, language);
 }
 
+std::vector<event_object> bookie_api_impl::get_events_with_name_containing(const std::string& sub_string, const std::string& language, uint32_t limit)
+{
+   FC_ASSERT(limit <= 1000, "You may request at most 1000 events at a time");
+   return get_plugin()->get_events_containing_sub_string(sub_string, language, limit);
+}
+
+std::vector<event_object> bookie_api_impl::get_events_with_name_starting_with(const std::string& prefix, const std::string& language, uint32_t limit)
+{
+   FC_ASSERT(limit <= 1000, "You may request at most 1000 events at a time");
+   return get_plugin()->get_events_starting_with(prefix, language, limit);
+}
+
 } // detail
 
 bookie_api::bookie_api(graphene::app::application& app) :
@@ -285,6 +316,17 @@ binned_order_book bookie_api::get_binned_order_book(graphene::chain::betting_mar
    return my->get_binned_order_book(betting_market_id, precision);
 }
 
+void bookie_api::subscribe_to_binned_order_book(std::function<void(const variant&)> callback,
+                                                graphene::chain::betting_market_id_type betting_market_id, int32_t precision)
+{
+   my->subscribe_to_binned_order_book(callback, betting_market_id, precision);
+}
+
+void bookie_api::unsubscribe_from_binned_order_book(graphene::chain::betting_market_id_type betting_market_id, int32_t precision)
+{
+   my->unsubscribe_from_binned_order_book(betting_market_id, precision);
+}
+
 asset bookie_api::get_total_matched_bet_amount_for_betting_market_group(betting_market_group_id_type group_id)
 {
     return my->get_total_matched_bet_amount_for_betting_market_group(group_id);
@@ -295,6 +337,16 @@ std::vector<event_object> bookie_api::get_events_containing_sub_string(const std
    return my->get_events_containing_sub_string(sub_string, language);
 }
 
+std::vector<event_object> bookie_api::get_events_with_name_containing(const std::string& sub_string, const std::string& language, uint32_t limit)
+{
+   return my->get_events_with_name_containing(sub_string, language, limit);
+}
+
+std::vector<event_object> bookie_api::get_events_with_name_starting_with(const std::string& prefix, const std::string& language, uint32_t limit)
+{
+   return my->get_events_with_name_starting_with(prefix, language, limit);
+}
+
 fc::variants bookie_api::get_objects(const vector<object_id_type>& ids) const
 {
    return my->get_objects(ids);
@@ -23,6 +23,7 @@
  */
 #include <graphene/bookie/bookie_plugin.hpp>
 #include <graphene/bookie/bookie_objects.hpp>
+#include <graphene/bookie/bookie_api.hpp>
 
 #include <graphene/app/impacted.hpp>
 
@@ -41,6 +42,9 @@
 
 #include <boost/polymorphic_cast.hpp>
 
+#include <algorithm>
+#include <limits>
+
 #if 0
 # ifdef DEFAULT_LOGGER
 #  undef DEFAULT_LOGGER
@@ -95,6 +99,265 @@ void persistent_bet_object_helper::object_modified(const object& after)
 }
 
 //////////// end bet_object ///////////////////
+
+namespace
+{
+   template<typename Bins>
+   void adjust_bin(Bins& bins, bet_multiplier_type backer_multiplier, share_type amount)
+   {
+      share_type& total = bins[backer_multiplier];
+      total += amount;
+      if (total == share_type())
+         bins.erase(backer_multiplier);
+   }
+
+   void append_order_bin(std::vector<order_bin>& order_bins, bet_multiplier_type backer_multiplier, share_type amount)
+   {
+      // bins beyond the multiplier limits are shown at the limit, so they may need merging
+      if (!order_bins.empty() && order_bins.back().backer_multiplier == backer_multiplier)
+      {
+         order_bins.back().amount_to_bet += amount;
+         return;
+      }
+      order_bin bin;
+      bin.backer_multiplier = backer_multiplier;
+      bin.amount_to_bet = amount;
+      order_bins.emplace_back(std::move(bin));
+   }
+}
+
+bet_multiplier_type binned_order_book_index::bin_size(int32_t precision)
+{
+   bet_multiplier_type bin_size = GRAPHENE_BETTING_ODDS_PRECISION;
+   if (precision > 0)
+      for (int32_t i = 0; i < precision; ++i) {
+         FC_ASSERT(bin_size > (GRAPHENE_BETTING_MIN_MULTIPLIER - GRAPHENE_BETTING_ODDS_PRECISION), "invalid precision");
+         bin_size /= 10;
+      }
+   else if (precision < 0)
+      for (int32_t i = 0; i > precision; --i) {
+         FC_ASSERT(bin_size < (GRAPHENE_BETTING_MAX_MULTIPLIER - GRAPHENE_BETTING_ODDS_PRECISION), "invalid precision");
+         bin_size *= 10;
+      }
+   return bin_size;
+}
+
+void binned_order_book_index::add(const bet_object& bet, bool remove)
+{
+   // bets still within their delay are not shown in the order book
+   if (bet.end_of_delay)
+      return;
+
+   market_bins& bins = _markets[bet.betting_market_id];
+   const share_type amount = remove ? -bet.amount_to_bet.amount : bet.amount_to_bet.amount;
+   bet_multiplier_type size = bin_size(min_precision);
+   for (uint32_t i = 0; i < precision_count; ++i, size /= 10)
+   {
+      // for back bets, we want to group all bets with odds from 3.0001 to 4 into the "4" bin
+      // for lay bets, we want to group all bets with odds from 3 to 3.9999 into the "3" bin
+      if (bet.back_or_lay == bet_type::back)
+         adjust_bin(bins.back[i], (bet.backer_multiplier + size - 1) / size * size, amount);
+      else
+         adjust_bin(bins.lay[i], bet.backer_multiplier / size * size, amount);
+   }
+   if (bins.back[0].empty() && bins.lay[0].empty())
+      _markets.erase(bet.betting_market_id);
+   _changed_markets.insert(bet.betting_market_id);
+}
+
+void binned_order_book_index::object_inserted(const object& obj)
+{
+   add(*boost::polymorphic_downcast<const bet_object*>(&obj), false);
+}
+
+void binned_order_book_index::object_restored(const object& obj)
+{
+   add(*boost::polymorphic_downcast<const bet_object*>(&obj), false);
+}
+
+void binned_order_book_index::object_removed(const object& obj)
+{
+   add(*boost::polymorphic_downcast<const bet_object*>(&obj), true);
+}
+
+void binned_order_book_index::about_to_modify(const object& before)
+{
+   add(*boost::polymorphic_downcast<const bet_object*>(&before), true);
+}
+
+void binned_order_book_index::object_modified(const object& after)
+{
+   add(*boost::polymorphic_downcast<const bet_object*>(&after), false);
+}
+
+const binned_order_book_index::market_bins* binned_order_book_index::find(betting_market_id_type betting_market_id) const
+{
+   auto iter = _markets.find(betting_market_id);
+   return iter != _markets.end() ? &iter->second : nullptr;
+}
+
+flat_set<betting_market_id_type> binned_order_book_index::take_changed_markets()
+{
+   flat_set<betting_market_id_type> result;
+   result.swap(_changed_markets);
+   return result;
+}
+
+//////////// end binned order books ///////////////////
+
+void event_name_index::add(event_id_type event_id, const internationalized_string_type& name)
+{
+   for (const std::pair<std::string, std::string>& pair : name)
+   {
+      language_names& names = _languages[pair.first];
+      std::string lower_case_name = boost::algorithm::to_lower_copy(pair.second);
+      for (size_t begin = 0; begin < lower_case_name.size(); ++begin)
+         for (size_t size = 1; size <= max_gram_size && begin + size <= lower_case_name.size(); ++size)
+            names.grams[lower_case_name.substr(begin, size)].insert(event_id);
+      names.by_name.insert(std::make_pair(lower_case_name, event_id));
+      names.names[event_id] = std::move(lower_case_name);
+   }
+}
+
+void event_name_index::remove(event_id_type event_id, const internationalized_string_type& name)
+{
+   for (const std::pair<std::string, std::string>& pair : name)
+   {
+      auto language_iter = _languages.find(pair.first);
+      if (language_iter == _languages.end())
+         continue;
+      language_names& names = language_iter->second;
+      auto name_iter = names.names.find(event_id);
+      if (name_iter == names.names.end())
+         continue;
+
+      const std::string& lower_case_name = name_iter->second;
+      for (size_t begin = 0; begin < lower_case_name.size(); ++begin)
+         for (size_t size = 1; size <= max_gram_size && begin + size <= lower_case_name.size(); ++size)
+         {
+            auto gram_iter = names.grams.find(lower_case_name.substr(begin, size));
+            if (gram_iter == names.grams.end())
+               continue;
+            gram_iter->second.erase(event_id);
+            if (gram_iter->second.empty())
+               names.grams.erase(gram_iter);
+         }
+      names.by_name.erase(std::make_pair(lower_case_name, event_id));
+      names.names.erase(name_iter);
+      if (names.names.empty())
+         _languages.erase(language_iter);
+   }
+}
+
+void event_name_index::object_inserted(const object& obj)
+{
+   const event_object& event_obj = *boost::polymorphic_downcast<const event_object*>(&obj);
+   add(event_obj.id, event_obj.name);
+}
+
+void event_name_index::object_restored(const object& obj)
+{
+   object_inserted(obj);
+}
+
+void event_name_index::object_removed(const object& obj)
+{
+   const event_object& event_obj = *boost::polymorphic_downcast<const event_object*>(&obj);
+   remove(event_obj.id, event_obj.name);
+}
+
+void event_name_index::about_to_modify(const object& before)
+{
+   _name_before_modify = boost::polymorphic_downcast<const event_object*>(&before)->name;
+}
+
+void event_name_index::object_modified(const object& after)
+{
+   // most updates change the status of an event, not its name
+   const event_object& event_obj = *boost::polymorphic_downcast<const event_object*>(&after);
+   if (event_obj.name == _name_before_modify)
+      return;
+   remove(event_obj.id, _name_before_modify);
+   add(event_obj.id, event_obj.name);
+}
+
+std::vector<event_id_type> event_name_index::find_containing(const std::string& language, const std::string& sub_string, size_t limit) const
+{
+   std::vector<event_id_type> result;
+   auto language_iter = _languages.find(language);
+   if (language_iter == _languages.end() || limit == 0)
+      return result;
+   const language_names& names = language_iter->second;
+   const std::string lower_case_sub_string = boost::algorithm::to_lower_copy(sub_string);
+
+   if (lower_case_sub_string.empty())
+   {
+      for (const auto& name : names.names)
+      {
+         result.push_back(name.first);
+         if (result.size() == limit)
+            break;
+      }
+      return result;
+   }
+
+   if (lower_case_sub_string.size() <= max_gram_size)
+   {
+      // short substrings are indexed themselves
+      auto gram_iter = names.grams.find(lower_case_sub_string);
+      if (gram_iter != names.grams.end())
+         result.assign(gram_iter->second.begin(),
+                       gram_iter->second.begin() + std::min(limit, gram_iter->second.size()));
+      return result;
+   }
+
+   // every event containing the substring is in the list of each of its trigrams
+   std::vector<const flat_set<event_id_type>*> lists;
+   for (size_t begin = 0; begin + max_gram_size <= lower_case_sub_string.size(); ++begin)
+   {
+      auto gram_iter = names.grams.find(lower_case_sub_string.substr(begin, max_gram_size));
+      if (gram_iter == names.grams.end())
+         return result;
+      lists.push_back(&gram_iter->second);
+   }
+   std::sort(lists.begin(), lists.end(), [](const flat_set<event_id_type>* a, const flat_set<event_id_type>* b) {
+      return a->size() < b->size();
+   });
+
+   for (const event_id_type& candidate : *lists.front())
+   {
+      bool in_all_lists = true;
+      for (size_t i = 1; i < lists.size() && in_all_lists; ++i)
+         in_all_lists = lists[i]->find(candidate) != lists[i]->end();
+      // having all the trigrams does not mean having them in a row
+      if (in_all_lists && names.names.at(candidate).find(lower_case_sub_string) != std::string::npos)
+      {
+         result.push_back(candidate);
+         if (result.size() == limit)
+            break;
+      }
+   }
+   return result;
+}
+
+std::vector<event_id_type> event_name_index::find_starting_with(const std::string& language, const std::string& prefix, size_t limit) const
+{
+   std::vector<event_id_type> result;
+   auto language_iter = _languages.find(language);
+   if (language_iter == _languages.end())
+      return result;
+   const language_names& names = language_iter->second;
+   const std::string lower_case_prefix = boost::algorithm::to_lower_copy(prefix);
+
+   for (auto iter = names.by_name.lower_bound(std::make_pair(lower_case_prefix, event_id_type()));
+        iter != names.by_name.end() && result.size() < limit &&
+        iter->first.compare(0, lower_case_prefix.size(), lower_case_prefix) == 0;
+        ++iter)
+      result.push_back(iter->second);
+   return result;
+}
+
+//////////// end event names ///////////////////
 class persistent_betting_market_object_helper : public secondary_index
 {
    public:
@@ -225,31 +488,21 @@ class bookie_plugin_impl
 
       asset get_total_matched_bet_amount_for_betting_market_group(betting_market_group_id_type group_id);
 
-      void fill_localized_event_strings();
+      binned_order_book get_binned_order_book(betting_market_id_type betting_market_id, int32_t precision);
 
-      std::vector<event_object> get_events_containing_sub_string(const std::string& sub_string, const std::string& language);
+      std::vector<event_object> get_events_containing_sub_string(const std::string& sub_string, const std::string& language, size_t limit);
+      std::vector<event_object> get_events_starting_with(const std::string& prefix, const std::string& language, size_t limit);
+      std::vector<event_object> get_events(const std::vector<event_id_type>& event_ids);
 
       graphene::chain::database& database()
       {
          return _self.database();
       }
 
-      //                1.18.          "Washington Capitals/Chicago Blackhawks"
-      typedef std::pair<event_id_type, std::string> event_string;
-      struct event_string_less : public std::less<const event_string&>
-      {
-          bool operator()(const event_string &_left, const event_string &_right) const
-          {
-              return (_left.first.instance < _right.first.instance);
-          }
-      };
-
-      typedef flat_set<event_string, event_string_less> event_string_set;
-      //       "en"
-      std::map<std::string, event_string_set> localized_event_strings;
-
       bookie_plugin& _self;
       flat_set<account_id_type> _tracked_accounts;
+      binned_order_book_index* _binned_order_books = nullptr;
+      const event_name_index*  _event_names = nullptr;
 };
 
 bookie_plugin_impl::~bookie_plugin_impl()
@@ -336,32 +589,6 @@ void bookie_plugin_impl::on_block_applied( const signed_block& )
                });
          }
       }
-      else if( op.op.which() == operation::tag<event_create_operation>::value )
-      {
-         FC_ASSERT(op.result.which() == operation_result::tag<object_id_type>::value);
-         //object_id_type object_id = op.result.get<object_id_type>();
-         event_id_type object_id = op.result.get<object_id_type>();
-         FC_ASSERT( db.find_object(object_id), "invalid event specified" );
-         const event_create_operation& event_create_op = op.op.get<event_create_operation>();
-         for(const std::pair<std::string, std::string>& pair : event_create_op.name)
-            localized_event_strings[pair.first].insert(event_string(object_id, pair.second));
-      }
-      else if( op.op.which() == operation::tag<event_update_operation>::value )
-      {
-         const event_update_operation& event_create_op = op.op.get<event_update_operation>();
-         if (!event_create_op.new_name.valid())
-            continue;
-         event_id_type event_id = event_create_op.event_id;
-         for(const std::pair<std::string, std::string>& pair : *event_create_op.new_name)
-         {
-            // try insert
-            std::pair<event_string_set::iterator, bool> result =
-               localized_event_strings[pair.first].insert(event_string(event_id, pair.second));
-            if (!result.second)
-               //  update string only
-               result.first->second = pair.second;
-         }
-      }
       else if ( op.op.which() == operation::tag<bet_canceled_operation>::value )
       {
          const bet_canceled_operation& bet_canceled_op = op.op.get<bet_canceled_operation>();
@@ -396,42 +623,32 @@ void bookie_plugin_impl::on_block_applied( const signed_block& )
       }
 
    }
-} FC_RETHROW_EXCEPTIONS( warn, "" ) }
 
-void bookie_plugin_impl::fill_localized_event_strings()
-{
-       graphene::chain::database& db = database();
-       const auto& event_index = db.get_index_type<event_object_index>().indices().get<by_id>();
-       auto event_itr = event_index.cbegin();
-       while (event_itr != event_index.cend())
-       {
-           const event_object& event_obj = *event_itr;
-           ++event_itr;
-           for(const std::pair<std::string, std::string>& pair : event_obj.name)
-           {
-                localized_event_strings[pair.first].insert(event_string(event_obj.id, pair.second));
-           }
-       }
-}
+   flat_set<betting_market_id_type> changed_markets = _binned_order_books->take_changed_markets();
+   if (!changed_markets.empty())
+      _self.binned_order_books_changed(changed_markets);
+} FC_RETHROW_EXCEPTIONS( warn, "" ) }
 
-std::vector<event_object> bookie_plugin_impl::get_events_containing_sub_string(const std::string& sub_string, const std::string& language)
+std::vector<event_object> bookie_plugin_impl::get_events(const std::vector<event_id_type>& event_ids)
 {
    graphene::chain::database& db = database();
    std::vector<event_object> events;
-   if (localized_event_strings.find(language) != localized_event_strings.end())
-   {
-      std::string lower_case_sub_string = boost::algorithm::to_lower_copy(sub_string);
-      const event_string_set& language_set = localized_event_strings[language];
-      for (const event_string& pair : language_set)
-      {
-         std::string lower_case_string = boost::algorithm::to_lower_copy(pair.second);
-         if (lower_case_string.find(lower_case_sub_string) != std::string::npos)
-            events.push_back(pair.first(db));
-      }
-   }
+   events.reserve(event_ids.size());
+   for (const event_id_type& event_id : event_ids)
+      events.push_back(event_id(db));
    return events;
 }
 
+std::vector<event_object> bookie_plugin_impl::get_events_containing_sub_string(const std::string& sub_string, const std::string& language, size_t limit)
+{
+   return get_events(_event_names->find_containing(language, sub_string, limit));
+}
+
+std::vector<event_object> bookie_plugin_impl::get_events_starting_with(const std::string& prefix, const std::string& language, size_t limit)
+{
+   return get_events(_event_names->find_starting_with(language, prefix, limit));
+}
+
 asset bookie_plugin_impl::get_total_matched_bet_amount_for_betting_market_group(betting_market_group_id_type group_id)
 {
    graphene::chain::database& db = database();
@@ -439,6 +656,26 @@ asset bookie_plugin_impl::get_total_matched_bet_amount_for_betting_market_group(
    const betting_market_group_object& betting_market_group =  group_id(db);
    return asset(betting_market_group.total_matched_bets_amount, betting_market_group.asset_id);
 }
+binned_order_book bookie_plugin_impl::get_binned_order_book(betting_market_id_type betting_market_id, int32_t precision)
+{
+   graphene::chain::database& db = database();
+   const chain_parameters& current_params = db.get_global_properties().parameters;
+
+   binned_order_book_index::bin_size(precision); // asserts that precision is valid
+   const uint32_t i = precision - binned_order_book_index::min_precision;
+
+   binned_order_book result;
+   const binned_order_book_index::market_bins* bins = _binned_order_books->find(betting_market_id);
+   if (!bins)
+      return result;
+
+   // backs at increasing odds then lays at decreasing odds, as the by_odds index orders them
+   for (const auto& bin : bins->back[i])
+      append_order_bin(result.aggregated_back_bets, std::min<bet_multiplier_type>(bin.first, current_params.max_bet_multiplier()), bin.second);
+   for (const auto& bin : bins->lay[i])
+      append_order_bin(result.aggregated_lay_bets, std::max<bet_multiplier_type>(bin.first, current_params.min_bet_multiplier()), bin.second);
+   return result;
+}
 } // end namespace detail
 
 bookie_plugin::bookie_plugin() :
@@ -467,11 +704,10 @@ void bookie_plugin::plugin_set_program_options(boost::program_options::options_d
 void bookie_plugin::plugin_initialize(const boost::program_options::variables_map& options)
 {
     ilog("bookie plugin: plugin_startup() begin");
-    database().force_slow_replays();
     database().applied_block.connect( [&]( const signed_block& b){ my->on_block_applied(b); } );
-    database().changed_objects.connect([&](const vector<object_id_type>& changed_object_ids, const fc::flat_set<graphene::chain::account_id_type>& impacted_accounts){ my->on_objects_changed(changed_object_ids); });
-    database().new_objects.connect([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) { my->on_objects_new(ids); });
-    database().removed_objects.connect([this](const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts) { my->on_objects_removed(ids); });
+    database().connect_changed_objects([&](const vector<object_id_type>& changed_object_ids, const fc::flat_set<graphene::chain::account_id_type>& impacted_accounts){ my->on_objects_changed(changed_object_ids); }, false);
+    database().connect_new_objects([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) { my->on_objects_new(ids); }, false);
+    database().connect_removed_objects([this](const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts) { my->on_objects_removed(ids); }, false);
 
 
     //auto event_index =
@@ -483,6 +719,7 @@ void bookie_plugin::plugin_initialize(const boost::program_options::variables_ma
     primary_index<bet_object_index>& nonconst_bet_object_idx = const_cast<primary_index<bet_object_index>&>(bet_object_idx);
     detail::persistent_bet_object_helper* persistent_bet_object_helper_index = nonconst_bet_object_idx.add_secondary_index<detail::persistent_bet_object_helper>();
     persistent_bet_object_helper_index->set_plugin_instance(this);
+    my->_binned_order_books = nonconst_bet_object_idx.add_secondary_index<detail::binned_order_book_index>();
 
     const primary_index<betting_market_object_index>& betting_market_object_idx = database().get_index_type<primary_index<betting_market_object_index> >();
     primary_index<betting_market_object_index>& nonconst_betting_market_object_idx = const_cast<primary_index<betting_market_object_index>&>(betting_market_object_idx);
@@ -498,6 +735,7 @@ void bookie_plugin::plugin_initialize(const boost::program_options::variables_ma
     primary_index<event_object_index>& nonconst_event_object_idx = const_cast<primary_index<event_object_index>&>(event_object_idx);
     detail::persistent_event_object_helper* persistent_event_object_helper_index = nonconst_event_object_idx.add_secondary_index<detail::persistent_event_object_helper>();
     persistent_event_object_helper_index->set_plugin_instance(this);
+    my->_event_names = nonconst_event_object_idx.add_secondary_index<detail::event_name_index>();
 
     ilog("bookie plugin: plugin_startup() end");
  }
@@ -505,7 +743,6 @@ void bookie_plugin::plugin_initialize(const boost::program_options::variables_ma
 void bookie_plugin::plugin_startup()
 {
    ilog("bookie plugin: plugin_startup()");
-    my->fill_localized_event_strings();
 }
 
 flat_set<account_id_type> bookie_plugin::tracked_accounts() const
@@ -518,10 +755,25 @@ asset bookie_plugin::get_total_matched_bet_amount_for_betting_market_group(betti
      ilog("bookie plugin: get_total_matched_bet_amount_for_betting_market_group($group_id)", ("group_d", group_id));
      return my->get_total_matched_bet_amount_for_betting_market_group(group_id);
 }
+binned_order_book bookie_plugin::get_binned_order_book(betting_market_id_type betting_market_id, int32_t precision)
+{
+    return my->get_binned_order_book(betting_market_id, precision);
+}
+
 std::vector<event_object> bookie_plugin::get_events_containing_sub_string(const std::string& sub_string, const std::string& language)
 {
     ilog("bookie plugin: get_events_containing_sub_string(${sub_string}, ${language})", (sub_string)(language));
-    return my->get_events_containing_sub_string(sub_string, language);
+    return my->get_events_containing_sub_string(sub_string, language, std::numeric_limits<size_t>::max());
+}
+
+std::vector<event_object> bookie_plugin::get_events_containing_sub_string(const std::string& sub_string, const std::string& language, size_t limit)
+{
+    return my->get_events_containing_sub_string(sub_string, language, limit);
+}
+
+std::vector<event_object> bookie_plugin::get_events_starting_with(const std::string& prefix, const std::string& language, size_t limit)
+{
+    return my->get_events_starting_with(prefix, language, limit);
 }
 
 } }
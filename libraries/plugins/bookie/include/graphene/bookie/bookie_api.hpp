@@ -23,6 +23,7 @@
  */
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -55,6 +56,14 @@ struct binned_order_book {
    std::vector<order_bin> aggregated_lay_bets;
 };
 
+/// the bins of a subscribed binned order book that changed in a block; a bin with nothing left in it has an amount of 0
+struct binned_order_book_update {
+   betting_market_id_type betting_market_id;
+   int32_t precision;
+   std::vector<order_bin> back_bins;
+   std::vector<order_bin> lay_bins;
+};
+
 struct matched_bet_object {
    // all fields from bet_object
    bet_id_type id;
@@ -88,8 +97,25 @@ class bookie_api
        * precision = 2 would bin on (1 - 1.01], (1.01 - 1.02]
        */
       binned_order_book get_binned_order_book(graphene::chain::betting_market_id_type betting_market_id, int32_t precision);
+
+      /**
+       * Calls callback with a binned_order_book_update after every block that changes the binned order book of
+       * betting_market_id at the given precision.  Updates are relative to the book as it was when subscribing.
+       */
+      void subscribe_to_binned_order_book(std::function<void(const variant&)> callback,
+                                          graphene::chain::betting_market_id_type betting_market_id, int32_t precision);
+      void unsubscribe_from_binned_order_book(graphene::chain::betting_market_id_type betting_market_id, int32_t precision);
+
       asset get_total_matched_bet_amount_for_betting_market_group(betting_market_group_id_type group_id);
       std::vector<event_object> get_events_containing_sub_string(const std::string& sub_string, const std::string& language);
+      /**
+       * Returns at most limit events whose name in the given language contains sub_string, ignoring case, lowest id first
+       */
+      std::vector<event_object> get_events_with_name_containing(const std::string& sub_string, const std::string& language, uint32_t limit);
+      /**
+       * Returns at most limit events whose name in the given language starts with prefix, ignoring case, in name order
+       */
+      std::vector<event_object> get_events_with_name_starting_with(const std::string& prefix, const std::string& language, uint32_t limit);
       fc::variants get_objects(const vector<object_id_type>& ids)const;
       std::vector<matched_bet_object> get_matched_bets_for_bettor(account_id_type bettor_id) const;
       std::vector<matched_bet_object> get_all_matched_bets_for_bettor(account_id_type bettor_id, bet_id_type start = bet_id_type(), unsigned limit = 1000) const;
@@ -100,12 +126,17 @@ class bookie_api
 
 FC_REFLECT(graphene::bookie::order_bin, (amount_to_bet)(backer_multiplier))
 FC_REFLECT(graphene::bookie::binned_order_book, (aggregated_back_bets)(aggregated_lay_bets))
+FC_REFLECT(graphene::bookie::binned_order_book_update, (betting_market_id)(precision)(back_bins)(lay_bins))
 FC_REFLECT(graphene::bookie::matched_bet_object, (id)(bettor_id)(betting_market_id)(amount_to_bet)(backer_multiplier)(back_or_lay)(end_of_delay)(amount_matched)(associated_operations))
 
 FC_API(graphene::bookie::bookie_api,
        (get_binned_order_book)
+       (subscribe_to_binned_order_book)
+       (unsubscribe_from_binned_order_book)
        (get_total_matched_bet_amount_for_betting_market_group)
        (get_events_containing_sub_string)
+       (get_events_with_name_containing)
+       (get_events_with_name_starting_with)
        (get_objects)
        (get_matched_bets_for_bettor)
        (get_all_matched_bets_for_bettor))
@@ -26,6 +26,8 @@
 #include <graphene/chain/betting_market_object.hpp>
 #include <graphene/chain/event_object.hpp>
 
+#include <unordered_map>
+
 namespace graphene { namespace bookie {
 using namespace chain;
 
@@ -186,6 +188,96 @@ typedef multi_index_container<
 
 typedef generic_index<persistent_bet_object, persistent_bet_multi_index_type> persistent_bet_index;
 
+//////////// binned order books //////////////////
+/**
+ * Keeps the amounts of the bets of every betting market that are not delayed, summed into bins for every precision
+ * the binned order book can be asked for, so that a binned order book is read without walking the bets.
+ * Back bets are filed under their odds rounded up to the bin size and lay bets under their odds rounded down;
+ * bins are not clamped to the chain's bet multiplier limits, that is left to the reader.
+ *
+ * This is a secondary index on the bet_object_index
+ */
+class binned_order_book_index : public secondary_index
+{
+   public:
+      /// the precisions bin_size() accepts
+      static const int32_t min_precision = -4;
+      static const int32_t max_precision = 4;
+      static const uint32_t precision_count = max_precision - min_precision + 1;
+
+      typedef std::map<bet_multiplier_type, share_type>                                     back_bins;
+      typedef std::map<bet_multiplier_type, share_type, std::greater<bet_multiplier_type> > lay_bins;
+
+      struct market_bins
+      {
+         /// back bins at increasing odds and lay bins at decreasing odds, one set per precision
+         back_bins back[precision_count];
+         lay_bins  lay[precision_count];
+      };
+
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_restored( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after ) override;
+
+      /// @return the width of a bin at precision decimal places, asserting that precision is valid
+      static bet_multiplier_type bin_size( int32_t precision );
+
+      /// @return the bins of betting_market_id, or nullptr if it has no bets that are not delayed
+      const market_bins* find( betting_market_id_type betting_market_id )const;
+
+      /// @return the markets whose bins changed since the last call
+      flat_set<betting_market_id_type> take_changed_markets();
+
+   private:
+      void add( const bet_object& bet, bool remove );
+
+      std::map<betting_market_id_type, market_bins> _markets;
+      flat_set<betting_market_id_type>              _changed_markets;
+};
+
+//////////// event names //////////////////
+/**
+ * A search index over the localized names of all events.  Every name is lower cased and each of its substrings of
+ * up to three bytes is mapped to the events whose name contains it, one index per language.  A substring search
+ * intersects the lists of the substring's trigrams, smallest first, and checks the few candidates left, so its cost
+ * depends on how many events match rather than on how many events there are.
+ *
+ * This is a secondary index on the event_object_index
+ */
+class event_name_index : public secondary_index
+{
+   public:
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_restored( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after ) override;
+
+      /// @return up to limit events whose name in language contains sub_string, ignoring case, lowest id first
+      std::vector<event_id_type> find_containing( const std::string& language, const std::string& sub_string, size_t limit )const;
+      /// @return up to limit events whose name in language starts with prefix, ignoring case, in name order
+      std::vector<event_id_type> find_starting_with( const std::string& language, const std::string& prefix, size_t limit )const;
+
+      /// the longest substrings indexed
+      static const size_t max_gram_size = 3;
+
+   private:
+      struct language_names
+      {
+         std::map<event_id_type, std::string>                                names;
+         std::set<std::pair<std::string, event_id_type> >                    by_name;
+         std::unordered_map<std::string, flat_set<event_id_type> >           grams;
+      };
+
+      void add( event_id_type event_id, const internationalized_string_type& name );
+      void remove( event_id_type event_id, const internationalized_string_type& name );
+
+      std::map<std::string, language_names> _languages;
+      internationalized_string_type         _name_before_modify;
+};
+
 } } } //graphene::bookie::detail
 
 FC_REFLECT_DERIVED( graphene::bookie::detail::persistent_event_object, (graphene::db::object), (ephemeral_event_object) )
@@ -50,6 +50,8 @@ namespace detail
    class bookie_plugin_impl;
 }
 
+struct binned_order_book;
+
 class bookie_plugin : public graphene::app::plugin
 {
    public:
@@ -65,6 +67,17 @@ class bookie_plugin : public graphene::app::plugin
       flat_set<account_id_type> tracked_accounts()const;
       asset get_total_matched_bet_amount_for_betting_market_group(betting_market_group_id_type group_id);
       std::vector<event_object> get_events_containing_sub_string(const std::string& sub_string, const std::string& language);
+      /// at most limit events whose name contains sub_string, ignoring case, lowest id first
+      std::vector<event_object> get_events_containing_sub_string(const std::string& sub_string, const std::string& language, size_t limit);
+      /// at most limit events whose name starts with prefix, ignoring case, in name order
+      std::vector<event_object> get_events_starting_with(const std::string& prefix, const std::string& language, size_t limit);
+      binned_order_book get_binned_order_book(betting_market_id_type betting_market_id, int32_t precision);
+
+      /**
+       *  Emitted from the database's applied_block signal with the betting markets whose binned order books changed
+       *  since the previous block.  Slots must not yield.
+       */
+      fc::signal<void(const flat_set<betting_market_id_type>&)> binned_order_books_changed;
 
       friend class detail::bookie_plugin_impl;
       std::unique_ptr<detail::bookie_plugin_impl> my;
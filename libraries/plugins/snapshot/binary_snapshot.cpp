@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/snapshot/binary_snapshot.hpp>
+
+#include <graphene/db/index.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/string.hpp>
+
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <fstream>
+
+namespace graphene { namespace snapshot_plugin {
+
+binary_snapshot capture_binary_snapshot( const graphene::chain::database& db, bool compress )
+{ try {
+   binary_snapshot result;
+   result.header.compressed = compress;
+   result.header.block_num  = db.head_block_num();
+   result.header.block_id   = db.head_block_id();
+   result.header.block_time = db.head_block_time();
+   result.header.chain_id   = db.get_chain_id();
+
+   db.inspect_all_indexes( [&result]( const graphene::db::index& idx ) {
+      std::shared_ptr<std::stringstream> data = std::make_shared<std::stringstream>(
+            std::ios_base::in | std::ios_base::out | std::ios_base::binary );
+      idx.save( *data );
+      FC_ASSERT( *data, "Unable to pack index ${s}.${t}",
+                 ("s", uint32_t(idx.object_space_id()))("t", uint32_t(idx.object_type_id())) );
+
+      binary_snapshot_index entry;
+      entry.space = idx.object_space_id();
+      entry.type  = idx.object_type_id();
+      entry.size  = uint64_t( data->tellp() );
+      graphene::db::index_file_header index_header;
+      fc::raw::unpack( *data, index_header );
+      entry.object_count = index_header.object_count;
+      data->seekg( 0 );
+
+      result.indexes.emplace_back( entry, data );
+   });
+   result.header.index_count = result.indexes.size();
+   return result;
+} FC_CAPTURE_AND_RETHROW() }
+
+void write_binary_snapshot( const binary_snapshot& snapshot, const fc::path& dest )
+{ try {
+   const fc::path tmp = dest.generic_string() + ".tmp";
+   {
+      std::ofstream file( tmp.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+      FC_ASSERT( file, "Unable to create ${f}", ("f", tmp) );
+      fc::raw::pack( file, snapshot.header );
+
+      boost::iostreams::filtering_ostream out;
+      if( snapshot.header.compressed )
+         out.push( boost::iostreams::zlib_compressor() );
+      out.push( file );
+      for( const auto& entry : snapshot.indexes )
+      {
+         fc::raw::pack( out, entry.first );
+         entry.second->seekg( 0 );
+         out << entry.second->rdbuf();
+      }
+      FC_ASSERT( out, "Unable to write ${f}", ("f", tmp) );
+      // flushes the compressor into the file
+      out.reset();
+      file.close();
+      FC_ASSERT( file, "Unable to write ${f}", ("f", tmp) );
+   }
+   fc::rename( tmp, dest );
+} FC_CAPTURE_AND_RETHROW( (dest) ) }
+
+binary_snapshot_header read_binary_snapshot( const fc::path& src,
+      const std::function<void( const binary_snapshot_index&, std::vector<char>&& )>& on_index )
+{ try {
+   std::ifstream file( src.generic_string(), std::ifstream::binary | std::ifstream::in );
+   FC_ASSERT( file, "Unable to open ${f}", ("f", src) );
+
+   binary_snapshot_header header;
+   fc::raw::unpack( file, header );
+   FC_ASSERT( header.magic == binary_snapshot_header::magic_value, "Not a binary snapshot" );
+   FC_ASSERT( header.format_version == binary_snapshot_header::current_format,
+              "Unsupported snapshot format ${f}", ("f", header.format_version) );
+
+   boost::iostreams::filtering_istream in;
+   if( header.compressed )
+      in.push( boost::iostreams::zlib_decompressor() );
+   in.push( file );
+   for( uint32_t i = 0; i < header.index_count; ++i )
+   {
+      binary_snapshot_index entry;
+      fc::raw::unpack( in, entry );
+      std::vector<char> data( entry.size );
+      if( entry.size > 0 )
+         in.read( data.data(), data.size() );
+      FC_ASSERT( in, "Snapshot is truncated in index ${s}.${t}",
+                 ("s", uint32_t(entry.space))("t", uint32_t(entry.type)) );
+      on_index( entry, std::move(data) );
+   }
+   return header;
+} FC_CAPTURE_AND_RETHROW( (src) ) }
+
+extracted_binary_snapshot extract_binary_snapshot( const fc::path& src, const fc::path& out_dir )
+{ try {
+   extracted_binary_snapshot result;
+   result.header = read_binary_snapshot( src, [&out_dir,&result]( const binary_snapshot_index& entry, std::vector<char>&& data ) {
+      const fc::path dir = out_dir / "object_database" / fc::to_string( uint32_t(entry.space) );
+      fc::create_directories( dir );
+      const fc::path file = dir / fc::to_string( uint32_t(entry.type) );
+      std::ofstream out( file.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+      out.write( data.data(), data.size() );
+      out.close();
+      FC_ASSERT( out, "Unable to write ${f}", ("f", file) );
+      result.files[ std::make_pair( entry.space, entry.type ) ] = file;
+      result.object_count += entry.object_count;
+   });
+   return result;
+} FC_CAPTURE_AND_RETHROW( (src)(out_dir) ) }
+
+} } // graphene::snapshot_plugin
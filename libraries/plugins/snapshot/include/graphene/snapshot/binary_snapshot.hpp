@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/time.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace graphene { namespace snapshot_plugin {
+
+/**
+ *  A binary snapshot file starts with this header, followed by index_count index entries.  Each entry is a
+ *  binary_snapshot_index and exactly size bytes holding the index in the same format primary_index::save()
+ *  writes to the object database, so an entry can be dropped into object_database/<space>/<type> as is.
+ *  If compressed is set, everything after the header is zlib compressed.
+ */
+struct binary_snapshot_header
+{
+   static const uint64_t magic_value    = 0x3150414e53475048ULL;
+   static const uint32_t current_format = 1;
+
+   uint64_t                        magic          = magic_value;
+   uint32_t                        format_version = current_format;
+   bool                            compressed     = false;
+   uint32_t                        block_num      = 0;
+   graphene::chain::block_id_type  block_id;
+   fc::time_point_sec              block_time;
+   graphene::chain::chain_id_type  chain_id;
+   uint32_t                        index_count    = 0;
+};
+
+struct binary_snapshot_index
+{
+   uint8_t  space        = 0;
+   uint8_t  type         = 0;
+   uint64_t object_count = 0;
+   uint64_t size         = 0;
+};
+
+/** the packed indexes of one snapshot, held in memory between capture and write */
+struct binary_snapshot
+{
+   binary_snapshot_header                                                           header;
+   std::vector< std::pair< binary_snapshot_index, std::shared_ptr<std::stringstream> > > indexes;
+};
+
+/**
+ *  Packs every registered index of db.  Must be called from the database thread while no block is being
+ *  applied; the result does not refer to db any more and may be written from another thread.
+ */
+binary_snapshot capture_binary_snapshot( const graphene::chain::database& db, bool compress );
+
+/** writes a captured snapshot to dest, going through a temporary file so dest is never left half written */
+void write_binary_snapshot( const binary_snapshot& snapshot, const fc::path& dest );
+
+/** reads a snapshot written by write_binary_snapshot, passing every index entry to on_index in file order */
+binary_snapshot_header read_binary_snapshot( const fc::path& src,
+      const std::function<void( const binary_snapshot_index&, std::vector<char>&& )>& on_index );
+
+/** the result of extracting a snapshot into a data directory */
+struct extracted_binary_snapshot
+{
+   binary_snapshot_header                             header;
+   /// the file each index was extracted to, by space and type, as object_database::open() takes them
+   std::map< std::pair<uint8_t,uint8_t>, fc::path >   files;
+   uint64_t                                           object_count = 0;
+};
+
+/** writes every index entry of the snapshot src to out_dir/object_database/<space>/<type> */
+extracted_binary_snapshot extract_binary_snapshot( const fc::path& src, const fc::path& out_dir );
+
+} } // graphene::snapshot_plugin
+
+FC_REFLECT( graphene::snapshot_plugin::binary_snapshot_header,
+            (magic)(format_version)(compressed)(block_num)(block_id)(block_time)(chain_id)(index_count) )
+FC_REFLECT( graphene::snapshot_plugin::binary_snapshot_index,
+            (space)(type)(object_count)(size) )
@@ -25,9 +25,13 @@
 
 #include <graphene/app/plugin.hpp>
 #include <graphene/chain/database.hpp>
+#include <graphene/utilities/thread_pool.hpp>
 
+#include <fc/thread/future.hpp>
 #include <fc/time.hpp>
 
+#include <memory>
+
 namespace graphene { namespace snapshot_plugin {
 
 class snapshot_plugin : public graphene::app::plugin {
@@ -47,10 +51,18 @@ class snapshot_plugin : public graphene::app::plugin {
 
    private:
        void check_snapshot( const graphene::chain::signed_block& b);
+       void create_binary_snapshot();
 
        uint32_t           snapshot_block = -1, last_block = 0;
        fc::time_point_sec snapshot_time = fc::time_point_sec::maximum(), last_time = fc::time_point_sec(1);
        fc::path           dest;
+       bool               binary_format = false;
+       bool               compress = false;
+
+       /** binary snapshots are written here, so that block processing only waits for the indexes to be packed */
+       std::unique_ptr<graphene::utilities::thread_pool> writer;
+       /** the last write queued; the writer runs writes in order, so the earlier ones are done when it is */
+       fc::future<void>                                  pending_write;
 };
 
 } } //graphene::snapshot_plugin
@@ -22,10 +22,12 @@
  * THE SOFTWARE.
  */
 #include <graphene/snapshot/snapshot.hpp>
+#include <graphene/snapshot/binary_snapshot.hpp>
 
 #include <graphene/chain/database.hpp>
 
 #include <fc/io/fstream.hpp>
+#include <fc/io/json.hpp>
 
 using namespace graphene::snapshot_plugin;
 using std::string;
@@ -36,6 +38,8 @@ namespace bpo = boost::program_options;
 static const char* OPT_BLOCK_NUM  = "snapshot-at-block";
 static const char* OPT_BLOCK_TIME = "snapshot-at-time";
 static const char* OPT_DEST       = "snapshot-to";
+static const char* OPT_FORMAT     = "snapshot-format";
+static const char* OPT_COMPRESS   = "snapshot-compress";
 
 void snapshot_plugin::plugin_set_program_options(
    boost::program_options::options_description& command_line_options,
@@ -44,7 +48,10 @@ void snapshot_plugin::plugin_set_program_options(
    command_line_options.add_options()
          (OPT_BLOCK_NUM, bpo::value<uint32_t>(), "Block number after which to do a snapshot")
          (OPT_BLOCK_TIME, bpo::value<string>(), "Block time (ISO format) after which to do a snapshot")
-         (OPT_DEST, bpo::value<string>(), "Pathname of JSON file where to store the snapshot")
+         (OPT_DEST, bpo::value<string>(), "Pathname of file where to store the snapshot")
+         (OPT_FORMAT, bpo::value<string>()->default_value("json"),
+          "Snapshot format: json writes one object per line, binary writes the packed indexes in the background")
+         (OPT_COMPRESS, bpo::bool_switch()->default_value(false), "Compress binary snapshots with zlib")
          ;
    config_file_options.add(command_line_options);
 }
@@ -62,6 +69,13 @@ void snapshot_plugin::plugin_initialize(const boost::program_options::variables_
    {
       FC_ASSERT( options.count(OPT_DEST), "Must specify snapshot-to in addition to snapshot-at-block or snapshot-at-time!" );
       dest = options[OPT_DEST].as<std::string>();
+      const std::string format = options[OPT_FORMAT].as<std::string>();
+      FC_ASSERT( format == "json" || format == "binary", "Unknown snapshot-format ${f}", ("f", format) );
+      binary_format = ( format == "binary" );
+      compress = options[OPT_COMPRESS].as<bool>();
+      FC_ASSERT( binary_format || !compress, "snapshot-compress requires snapshot-format binary" );
+      if( binary_format )
+         writer.reset( new graphene::utilities::thread_pool( "snapshot", 1 ) );
       if( options.count(OPT_BLOCK_NUM) )
          snapshot_block = options[OPT_BLOCK_NUM].as<uint32_t>();
       if( options.count(OPT_BLOCK_TIME) )
@@ -77,7 +91,15 @@ void snapshot_plugin::plugin_initialize(const boost::program_options::variables_
 
 void snapshot_plugin::plugin_startup() {}
 
-void snapshot_plugin::plugin_shutdown() {}
+void snapshot_plugin::plugin_shutdown()
+{
+   if( pending_write.valid() && !pending_write.ready() )
+   {
+      ilog( "snapshot plugin: waiting for snapshot to be written" );
+      pending_write.wait();
+   }
+   writer.reset();
+}
 
 static void create_snapshot( const graphene::chain::database& db, const fc::path& dest )
 {
@@ -92,32 +114,52 @@ static void create_snapshot( const graphene::chain::database& db, const fc::path
       wlog( "Failed to open snapshot destination: ${ex}", ("ex",e) );
       return;
    }
-   for( uint32_t space_id = 0; space_id < 256; space_id++ )
-      for( uint32_t type_id = 0; type_id < 256; type_id++ )
-      {
-         try
-         {
-            db.get_index( (uint8_t)space_id, (uint8_t)type_id );
-         }
-         catch (fc::assert_exception& e)
-         {
-            continue;
-         }
-         auto& index = db.get_index( (uint8_t)space_id, (uint8_t)type_id );
-         index.inspect_all_objects( [&out]( const graphene::db::object& o ) {
-            out << fc::json::to_string( o.to_variant() ) << '\n';
-         });
-      }
+   db.inspect_all_indexes( [&out]( const graphene::db::index& index ) {
+      index.inspect_all_objects( [&out]( const graphene::db::object& o ) {
+         out << fc::json::to_string( o.to_variant() ) << '\n';
+      });
+   });
    out.close();
    ilog("snapshot plugin: created snapshot");
 }
 
+void snapshot_plugin::create_binary_snapshot()
+{
+   ilog("snapshot plugin: capturing binary snapshot");
+   auto start = fc::time_point::now();
+   std::shared_ptr<binary_snapshot> snapshot = std::make_shared<binary_snapshot>(
+         capture_binary_snapshot( database(), compress ) );
+   ilog( "snapshot plugin: captured ${n} indexes at block ${b} in ${t} ms, writing in background",
+         ("n", snapshot->indexes.size())("b", snapshot->header.block_num)
+         ("t", (fc::time_point::now() - start).count() / 1000) );
+
+   // the writer has a single thread, so this write queues up behind one still in flight instead of
+   // waiting for it here, which would let other tasks run in the middle of applied_block
+   const fc::path file = dest;
+   pending_write = writer->async( [snapshot, file]() {
+      try
+      {
+         write_binary_snapshot( *snapshot, file );
+         ilog( "snapshot plugin: wrote binary snapshot to ${f}", ("f", file) );
+      }
+      catch( const fc::exception& e )
+      {
+         wlog( "Failed to write binary snapshot: ${ex}", ("ex", e) );
+      }
+   }, "write binary snapshot" );
+}
+
 void snapshot_plugin::check_snapshot( const graphene::chain::signed_block& b )
 { try {
     uint32_t current_block = b.block_num();
     if( (last_block < snapshot_block && snapshot_block <= current_block)
            || (last_time < snapshot_time && snapshot_time <= b.timestamp) )
-       create_snapshot( database(), dest );
+    {
+       if( binary_format )
+          create_binary_snapshot();
+       else
+          create_snapshot( database(), dest );
+    }
     last_block = current_block;
     last_time = b.timestamp;
 } FC_LOG_AND_RETHROW() }
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <fc/thread/thread.hpp>
+#include <fc/thread/future.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/optional.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace utilities {
+
+/**
+ * @class thread_pool
+ * @brief a fixed set of fc::threads that CPU bound work can be dispatched to
+ *
+ * Work handed to the pool must not touch the chain database; it is meant for pure computations such as signature
+ * recovery, hashing or deserialization whose results are then consumed by the calling thread.  Waiting for results
+ * yields the calling fc::thread, so callers must only wait at points where other tasks may safely run.
+ */
+class thread_pool
+{
+   public:
+      thread_pool( const std::string& name, uint32_t thread_count );
+      ~thread_pool();
+
+      uint32_t size()const { return _threads.size(); }
+
+      /** schedule f on the next thread of the pool, in round-robin order */
+      template<typename Functor>
+      auto async( Functor&& f, const char* desc = "thread_pool task" ) -> fc::future<decltype(f())>
+      {
+         FC_ASSERT( !_threads.empty(), "thread pool has no threads" );
+         fc::thread& t = *_threads[ _next_thread++ % _threads.size() ];
+         return t.async( std::forward<Functor>(f), desc );
+      }
+
+      /**
+       * Calls f(i) for every i in [0, count), splitting the range into one contiguous chunk per thread, and waits
+       * for all chunks.  Everything runs on the calling thread if the pool is empty.  If any call throws, the first
+       * exception is rethrown once all chunks have finished.
+       */
+      template<typename Functor>
+      void for_each_index( size_t count, const Functor& f )
+      {
+         if( _threads.empty() || count < 2 )
+         {
+            for( size_t i = 0; i < count; ++i )
+               f(i);
+            return;
+         }
+
+         const size_t chunks = std::min<size_t>( _threads.size(), count );
+         const size_t chunk_size = (count + chunks - 1) / chunks;
+         std::vector< fc::future<void> > results;
+         results.reserve( chunks );
+         for( size_t begin = 0; begin < count; begin += chunk_size )
+         {
+            const size_t end = std::min( begin + chunk_size, count );
+            results.push_back( async( [&f, begin, end]() {
+               for( size_t i = begin; i < end; ++i )
+                  f(i);
+            }, "thread_pool for_each_index" ) );
+         }
+
+         fc::optional<fc::exception> except;
+         for( auto& result : results )
+         {
+            try {
+               result.wait();
+            } catch( const fc::exception& e ) {
+               if( !except )
+                  except = e;
+            }
+         }
+         if( except )
+            throw *except;
+      }
+
+      /**
+       * Same as for_each_index, but blocks the calling OS thread while the chunks run instead of yielding the calling
+       * fc::thread.  Use it in the middle of applying a block, where no other task may be allowed to run meanwhile.
+       */
+      template<typename Functor>
+      void for_each_index_blocking( size_t count, const Functor& f )
+      {
+         if( _threads.empty() || count < 2 )
+         {
+            for( size_t i = 0; i < count; ++i )
+               f(i);
+            return;
+         }
+
+         const size_t chunks = std::min<size_t>( _threads.size(), count );
+         const size_t chunk_size = (count + chunks - 1) / chunks;
+         std::vector< std::future<void> > results;
+         results.reserve( chunks );
+         for( size_t begin = 0; begin < count; begin += chunk_size )
+         {
+            const size_t end = std::min( begin + chunk_size, count );
+            std::shared_ptr< std::promise<void> > done = std::make_shared< std::promise<void> >();
+            results.push_back( done->get_future() );
+            async( [&f, begin, end, done]() {
+               try {
+                  for( size_t i = begin; i < end; ++i )
+                     f(i);
+                  done->set_value();
+               } catch( ... ) {
+                  done->set_exception( std::current_exception() );
+               }
+            }, "thread_pool for_each_index_blocking" );
+         }
+
+         fc::optional<fc::exception> except;
+         for( auto& result : results )
+         {
+            try {
+               result.get();
+            } catch( const fc::exception& e ) {
+               if( !except )
+                  except = e;
+            } catch( const std::exception& e ) {
+               if( !except )
+                  except = fc::exception( FC_LOG_MESSAGE( error, "${what}", ("what", std::string( e.what() )) ) );
+            }
+         }
+         if( except )
+            throw *except;
+      }
+
+   private:
+      std::vector< std::unique_ptr<fc::thread> > _threads;
+      size_t                                     _next_thread = 0;
+};
+
+} } // graphene::utilities
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/database.hpp>
+#include <graphene/snapshot/binary_snapshot.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <iostream>
+
+using namespace graphene::snapshot_plugin;
+namespace bpo = boost::program_options;
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description cli_options("Read a binary snapshot back into an object database");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("snapshot,s", bpo::value<std::string>(), "Binary snapshot written by the snapshot plugin")
+            ("out,o", bpo::value<std::string>(), "Data directory to extract the object database into")
+            ("verify", "Load the extracted indexes and check them against the snapshot header")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line(argc, argv, cli_options), options );
+      }
+      catch (const bpo::error& e)
+      {
+         std::cerr << "snapshot_util:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") )
+      {
+         std::cout << cli_options << "\n";
+         return 1;
+      }
+
+      if( !options.count("snapshot") || !options.count("out") )
+      {
+         std::cerr << "--snapshot and --out options are required\n";
+         return 1;
+      }
+
+      const fc::path out_dir = options["out"].as<std::string>();
+      const extracted_binary_snapshot extracted = extract_binary_snapshot( options["snapshot"].as<std::string>(), out_dir );
+      const binary_snapshot_header& header = extracted.header;
+
+      std::cerr << "snapshot_util:  extracted " << header.index_count << " indexes with " << extracted.object_count
+                << " objects at block " << header.block_num << " (" << std::string( header.block_id ) << ")\n";
+
+      if( options.count("verify") )
+      {
+         // only the core indexes are registered here, plugin indexes are extracted but not loaded
+         graphene::chain::database db;
+         db.object_database::open( out_dir, extracted.files );
+         FC_ASSERT( db.head_block_id() == header.block_id, "Head block ${h} does not match snapshot block ${b}",
+                    ("h", db.head_block_id())("b", header.block_id) );
+         FC_ASSERT( db.get_chain_id() == header.chain_id, "Chain id ${c} does not match snapshot chain id ${s}",
+                    ("c", db.get_chain_id())("s", header.chain_id) );
+         std::cerr << "snapshot_util:  verified head block and chain id\n";
+      }
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cout << e.to_detail_string() << "\n";
+      return 1;
+   }
+   return 0;
+}
@@ -40,7 +40,12 @@
 
 using namespace graphene;
 
-BOOST_AUTO_TEST_CASE( two_node_network )
+/**
+ * Connects two nodes, broadcasts a transaction from the first and a block from the second, and checks that
+ * the other node applied them.  With decoding_threads > 0 both nodes decode the messages on their p2p
+ * decoding pool.
+ */
+static void check_two_node_network( uint32_t decoding_threads, const std::string& endpoint1, const std::string& endpoint2 )
 {
    using namespace graphene::chain;
    using namespace graphene::app;
@@ -56,7 +61,9 @@ BOOST_AUTO_TEST_CASE( two_node_network )
       graphene::app::application app1;
       app1.register_plugin<graphene::account_history::account_history_plugin>();
       boost::program_options::variables_map cfg;
-      cfg.emplace("p2p-endpoint", boost::program_options::variable_value(string("127.0.0.1:3939"), false));
+      cfg.emplace("p2p-endpoint", boost::program_options::variable_value(endpoint1, false));
+      if( decoding_threads > 0 )
+         cfg.emplace("p2p-decoding-threads", boost::program_options::variable_value(decoding_threads, false));
       app1.initialize(app_dir.path(), cfg);
 
       BOOST_TEST_MESSAGE( "Creating and initializing app2" );
@@ -65,8 +72,8 @@ BOOST_AUTO_TEST_CASE( two_node_network )
       app2.register_plugin<account_history::account_history_plugin>();
       auto cfg2 = cfg;
       cfg2.erase("p2p-endpoint");
-      cfg2.emplace("p2p-endpoint", boost::program_options::variable_value(string("127.0.0.1:4040"), false));
-      cfg2.emplace("seed-node", boost::program_options::variable_value(vector<string>{"127.0.0.1:3939"}, false));
+      cfg2.emplace("p2p-endpoint", boost::program_options::variable_value(endpoint2, false));
+      cfg2.emplace("seed-node", boost::program_options::variable_value(vector<string>{endpoint1}, false));
       app2.initialize(app2_dir.path(), cfg2);
 
       BOOST_TEST_MESSAGE( "Starting app1 and waiting 500 ms" );
@@ -150,3 +157,13 @@ BOOST_AUTO_TEST_CASE( two_node_network )
       throw;
    }
 }
+
+BOOST_AUTO_TEST_CASE( two_node_network )
+{
+   check_two_node_network( 0, "127.0.0.1:3939", "127.0.0.1:4040" );
+}
+
+BOOST_AUTO_TEST_CASE( two_node_network_with_decoding_threads )
+{
+   check_two_node_network( 2, "127.0.0.1:3940", "127.0.0.1:4041" );
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "bench_report.hpp"
+
+#include <fc/io/json.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/variant_object.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+namespace graphene { namespace chain { namespace test {
+
+namespace {
+
+std::vector<fc::variant>& reported_workloads()
+{
+   static std::vector<fc::variant> workloads;
+   return workloads;
+}
+
+int64_t percentile( const std::vector<int64_t>& sorted, uint32_t pct )
+{
+   if( sorted.empty() )
+      return 0;
+   size_t rank = (sorted.size() * pct + 99) / 100;
+   return sorted[ std::max<size_t>( rank, 1 ) - 1 ];
+}
+
+}
+
+bench_recorder::bench_recorder( const std::string& name )
+   : _name( name )
+{
+}
+
+void bench_recorder::report()
+{
+   std::vector<int64_t> sorted = _block_us;
+   std::sort( sorted.begin(), sorted.end() );
+   const int64_t block_us = std::accumulate( sorted.begin(), sorted.end(), int64_t(0) );
+   const int64_t total_us = std::max<int64_t>( _push_us + block_us, 1 );
+
+   fc::mutable_variant_object result;
+   result( "name", _name )
+         ( "ops", _ops )
+         ( "blocks", uint64_t( sorted.size() ) )
+         ( "total_us", total_us )
+         ( "ops_per_sec", _ops * 1000000 / uint64_t( total_us ) )
+         ( "block_apply_us_p50", percentile( sorted, 50 ) )
+         ( "block_apply_us_p99", percentile( sorted, 99 ) )
+         ( "block_apply_us_max", sorted.empty() ? int64_t(0) : sorted.back() )
+         ( "allocations", _allocations )
+         ( "allocations_per_op", _ops ? _allocations / _ops : uint64_t(0) );
+
+   ilog( "${r}", ("r", result) );
+   reported_workloads().push_back( fc::variant( result ) );
+}
+
+void write_bench_report()
+{
+   if( reported_workloads().empty() )
+      return;
+
+   const char* path = std::getenv( "CHAIN_BENCH_REPORT" );
+   fc::mutable_variant_object report;
+#ifdef NDEBUG
+   report( "build", "release" );
+#else
+   report( "build", "debug" );
+#endif
+   report( "workloads", reported_workloads() );
+   fc::json::save_to_file( fc::variant( report ), fc::path( path ? path : "chain_bench_report.json" ) );
+}
+
+} } } // graphene::chain::test
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <fc/time.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace chain { namespace test {
+
+/// number of heap allocations made by the process so far, counted by the operator new of chain_bench
+uint64_t allocation_count();
+
+/**
+ * @class bench_recorder
+ * @brief collects the timings of one benchmark workload for the machine readable chain_bench report
+ *
+ * A workload is made of operations pushed to the pending state and of blocks applied on top of them; both
+ * count towards the throughput, only the blocks towards the per-block latency percentiles.  Calling report()
+ * logs the result and adds it to the JSON report written when chain_bench exits, to the file named by the
+ * CHAIN_BENCH_REPORT environment variable or chain_bench_report.json.
+ */
+class bench_recorder
+{
+   public:
+      explicit bench_recorder( const std::string& name );
+
+      /// times f, which pushes count operations
+      template<typename Functor>
+      void push_ops( uint64_t count, Functor&& f )
+      {
+         const uint64_t allocations = allocation_count();
+         const fc::time_point start = fc::time_point::now();
+         f();
+         _push_us += (fc::time_point::now() - start).count();
+         _allocations += allocation_count() - allocations;
+         _ops += count;
+      }
+
+      /// times f, which applies one block holding count operations
+      template<typename Functor>
+      void apply_block( uint64_t count, Functor&& f )
+      {
+         const uint64_t allocations = allocation_count();
+         const fc::time_point start = fc::time_point::now();
+         f();
+         _block_us.push_back( (fc::time_point::now() - start).count() );
+         _allocations += allocation_count() - allocations;
+         _ops += count;
+      }
+
+      /// counts operations that were carried out by blocks already timed
+      void count_ops( uint64_t count ) { _ops += count; }
+
+      void report();
+
+   private:
+      std::string           _name;
+      uint64_t              _ops = 0;
+      int64_t               _push_us = 0;
+      std::vector<int64_t>  _block_us;
+      uint64_t              _allocations = 0;
+};
+
+/// writes every reported workload to the JSON report
+void write_bench_report();
+
+} } } // graphene::chain::test
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+
+#include "../common/betting_test_markets.hpp"
+#include "bench_report.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( betting_benchmarks, database_fixture )
+
+/**
+ * Places crossing lay bets against a market holding back bets at every permitted odds level up to 2.0,
+ * each block taking liquidity off the top of the book.
+ */
+BOOST_AUTO_TEST_CASE( bet_placement_deep_book_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t bets_per_level = 20;
+      const uint32_t blocks = 20;
+#else
+      const uint32_t bets_per_level = 2;
+      const uint32_t blocks = 5;
+#endif
+      const uint32_t bets_per_block = 100;
+      const uint32_t account_count = 50;
+
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+
+      vector<account_id_type> bettors;
+      for( uint32_t i = 0; i < account_count; ++i )
+      {
+         bettors.push_back( create_account( "deepbook" + fc::to_string(i) ).id );
+         transfer( committee_account, bettors.back(), asset(100000000) );
+      }
+      generate_block();
+
+      // odds from 1.01 to 2.00, the finest increment the default rules permit
+      uint32_t resting_bets = 0;
+      for( bet_multiplier_type odds = 10100; odds <= 20000; odds += 100 )
+         for( uint32_t i = 0; i < bets_per_level; ++i )
+         {
+            place_bet( bettors[resting_bets % account_count], capitals_win_market.id, bet_type::back,
+                       asset(10000, asset_id_type()), odds );
+            ++resting_bets;
+         }
+      generate_block();
+
+      bench_recorder run( "bet_placement_deep_book" );
+      for( uint32_t b = 0; b < blocks; ++b )
+      {
+         run.push_ops( bets_per_block, [&]() {
+            for( uint32_t i = 0; i < bets_per_block; ++i )
+               place_bet( bettors[i % account_count], capitals_win_market.id, bet_type::lay,
+                          asset(50, asset_id_type()), 20000 );
+         });
+         run.apply_block( bets_per_block, [&]() { generate_block(); } );
+      }
+      run.report();
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+/**
+ * Places matching bets on an in-play market every block, so that each block also releases the bets placed
+ * when the live betting delay began.
+ */
+BOOST_AUTO_TEST_CASE( delayed_bet_release_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t blocks = 50;
+#else
+      const uint32_t blocks = 10;
+#endif
+      const uint32_t bets_per_block = 100;
+      const uint32_t account_count = 50;
+
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+
+      vector<account_id_type> bettors;
+      for( uint32_t i = 0; i < account_count; ++i )
+      {
+         bettors.push_back( create_account( "delayed" + fc::to_string(i) ).id );
+         transfer( committee_account, bettors.back(), asset(100000000) );
+      }
+      update_betting_market_group( moneyline_betting_markets.id, _status = betting_market_group_status::in_play );
+      generate_block();
+
+      bench_recorder run( "delayed_bet_release" );
+      for( uint32_t b = 0; b < blocks; ++b )
+      {
+         run.push_ops( bets_per_block, [&]() {
+            for( uint32_t i = 0; i < bets_per_block; ++i )
+               place_bet( bettors[i % account_count], capitals_win_market.id, i % 2 ? bet_type::lay : bet_type::back,
+                          asset(1000, asset_id_type()), 20000 );
+         });
+         run.apply_block( 0, [&]() { generate_block(); } );
+      }
+      run.report();
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+/**
+ * Freezes and unfreezes an in-play betting market group holding a deep book and a queue of delayed bets,
+ * one status change per block.
+ */
+BOOST_AUTO_TEST_CASE( in_play_freeze_unfreeze_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t resting_bets = 5000;
+      const uint32_t rounds = 20;
+#else
+      const uint32_t resting_bets = 500;
+      const uint32_t rounds = 5;
+#endif
+      const uint32_t delayed_bets_per_round = 100;
+      const uint32_t account_count = 50;
+
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+
+      vector<account_id_type> bettors;
+      for( uint32_t i = 0; i < account_count; ++i )
+      {
+         bettors.push_back( create_account( "freeze" + fc::to_string(i) ).id );
+         transfer( committee_account, bettors.back(), asset(100000000) );
+      }
+      generate_block();
+
+      for( uint32_t i = 0; i < resting_bets; ++i )
+         place_bet( bettors[i % account_count], capitals_win_market.id, bet_type::back,
+                    asset(1000, asset_id_type()), 10100 + (i % 100) * 100 );
+      generate_block();
+
+      // going in play cancels the unmatched bets, so rebuild the book once in play
+      update_betting_market_group( moneyline_betting_markets.id, _status = betting_market_group_status::in_play );
+      generate_block();
+      for( uint32_t i = 0; i < resting_bets; ++i )
+         place_bet( bettors[i % account_count], capitals_win_market.id, bet_type::back,
+                    asset(1000, asset_id_type()), 10100 + (i % 100) * 100 );
+      generate_blocks( db.head_block_time() + fc::seconds( 10 ) );
+
+      bench_recorder run( "in_play_freeze_unfreeze" );
+      for( uint32_t r = 0; r < rounds; ++r )
+      {
+         for( uint32_t i = 0; i < delayed_bets_per_round; ++i )
+            place_bet( bettors[i % account_count], blackhawks_win_market.id, bet_type::back,
+                       asset(1000, asset_id_type()), 20000 );
+         generate_block();
+
+         run.push_ops( 1, [&]() {
+            update_betting_market_group( moneyline_betting_markets.id, _status = betting_market_group_status::frozen );
+         });
+         run.apply_block( 0, [&]() { generate_block(); } );
+         run.push_ops( 1, [&]() {
+            update_betting_market_group( moneyline_betting_markets.id, _status = betting_market_group_status::in_play );
+         });
+         run.apply_block( 0, [&]() { generate_block(); } );
+      }
+      run.report();
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
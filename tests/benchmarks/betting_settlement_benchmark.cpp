@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+
+#include "../common/betting_test_markets.hpp"
+#include "bench_report.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( betting_settlement_benchmarks, database_fixture )
+
+/**
+ * Settles a betting market group holding one matched position per bettor, once with serial
+ * settlement and once per configured number of settlement threads.
+ */
+BOOST_AUTO_TEST_CASE( settle_betting_market_group_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t bettor_count = 2000;
+#else
+      const uint32_t bettor_count = 200;
+#endif
+      const uint32_t rounds = 5;
+
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+      const betting_market_group_id_type group_id = moneyline_betting_markets.id;
+
+      vector<account_id_type> bettors;
+      for( uint32_t i = 0; i < bettor_count; ++i )
+      {
+         bettors.push_back( create_account( "setbench" + fc::to_string(i) ).id );
+         transfer( committee_account, bettors.back(), asset(100000) );
+      }
+      generate_block();
+
+      // pair the bettors up so that every bet is matched and every bettor ends up with a position
+      for( uint32_t i = 0; i < bettor_count; ++i )
+         place_bet( bettors[i], capitals_win_market.id, i % 2 ? bet_type::lay : bet_type::back,
+                    asset(1000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION );
+      generate_block();
+      BOOST_REQUIRE_EQUAL( db.get_index_type<betting_market_position_index>().indices().size(), bettor_count );
+
+      resolve_betting_market_group( group_id, {{capitals_win_market.id, betting_market_resolution_type::win},
+                                               {blackhawks_win_market.id, betting_market_resolution_type::not_win}} );
+      signed_block b = generate_block();
+      BOOST_REQUIRE( db.find( group_id ) == nullptr );
+
+      for( uint32_t threads : { 0, 1, 2, 4, 8 } )
+      {
+         db.set_settlement_threads( threads );
+         bench_recorder run( "settle_betting_market_group_" + fc::to_string( threads ) + "_threads" );
+         for( uint32_t r = 0; r < rounds; ++r )
+         {
+            db.pop_block();
+            run.apply_block( bettor_count, [&]() { db.push_block( b, database::skip_witness_signature ); } );
+         }
+         run.report();
+         BOOST_CHECK( db.head_block_id() == b.id() );
+         BOOST_CHECK( db.find( group_id ) == nullptr );
+      }
+      db.set_settlement_threads( 0 );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
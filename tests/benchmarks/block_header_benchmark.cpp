@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/protocol/block.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+BOOST_FIXTURE_TEST_SUITE( block_header_benchmarks, database_fixture )
+
+/**
+ * Compares repeated id()/digest()/signee() calls on a header whose memoized values are current
+ * against a header that is modified before every call and therefore has to rehash.
+ */
+BOOST_AUTO_TEST_CASE( block_id_cache_bench )
+{
+   try {
+      const uint32_t iterations = 20000;
+
+      signed_block b = generate_block();
+      const fc::ecc::public_key expected = b.signee();
+
+      auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < iterations; ++i )
+      {
+         BOOST_CHECK( b.id() == db.head_block_id() );
+         b.digest();
+         b.signee();
+      }
+      auto cached = fc::time_point::now() - start;
+
+      const block_id_type id = b.id();
+      const fc::time_point_sec timestamp = b.timestamp;
+      start = fc::time_point::now();
+      for( uint32_t i = 0; i < iterations; ++i )
+      {
+         // alternating the timestamp invalidates the memoized values on every call
+         b.timestamp = timestamp + (i & 1);
+         BOOST_CHECK( (b.id() == id) == ((i & 1) == 0) );
+         b.digest();
+      }
+      auto uncached = fc::time_point::now() - start;
+      b.timestamp = timestamp;
+      BOOST_CHECK( b.id() == id );
+      BOOST_CHECK( b.signee() == expected );
+
+      ilog( "block header id/digest: ${c} ns/call cached, ${u} ns/call recomputed",
+            ("c", cached.count() * 1000 / iterations)("u", uncached.count() * 1000 / iterations) );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+/**
+ * Pushes the same block with a warm header cache and as a freshly deserialized copy, which is what
+ * the p2p layer and the block log hand to push_block().  The hashes a freshly deserialized block needs
+ * once, the header id and signee and the merkle root, are timed on their own for comparison.
+ */
+BOOST_AUTO_TEST_CASE( push_block_header_cache_bench )
+{
+   try {
+      const uint32_t rounds = 200;
+
+      const account_id_type alice_id = create_account( "alice" ).id;
+      for( uint32_t i = 1; i <= 10; ++i )
+         transfer( account_id_type(), alice_id, asset( i ) );
+      signed_block b = generate_block();
+      BOOST_REQUIRE( b.transactions.size() > 1 );
+      const vector<char> packed = fc::raw::pack( b );
+
+      auto start = fc::time_point::now();
+      for( uint32_t r = 0; r < rounds; ++r )
+      {
+         db.pop_block();
+         db.push_block( b );
+      }
+      auto warm = fc::time_point::now() - start;
+
+      start = fc::time_point::now();
+      for( uint32_t r = 0; r < rounds; ++r )
+      {
+         db.pop_block();
+         db.push_block( fc::raw::unpack<signed_block>( packed ) );
+      }
+      auto cold = fc::time_point::now() - start;
+      BOOST_CHECK( db.head_block_id() == b.id() );
+
+      fc::microseconds header_hashes;
+      fc::microseconds merkle_roots;
+      for( uint32_t r = 0; r < rounds; ++r )
+      {
+         const signed_block copy = fc::raw::unpack<signed_block>( packed );
+         start = fc::time_point::now();
+         copy.id();
+         copy.signee();
+         header_hashes += fc::time_point::now() - start;
+         start = fc::time_point::now();
+         BOOST_CHECK( copy.calculate_merkle_root() == b.transaction_merkle_root );
+         merkle_roots += fc::time_point::now() - start;
+      }
+
+      ilog( "push_block: ${w} us/block with cached header, ${c} us/block deserialized",
+            ("w", warm.count() / rounds)("c", cold.count() / rounds) );
+      ilog( "hashing a deserialized block of ${n} transactions: ${h} us for its id and signee, ${m} us for its merkle root",
+            ("n", b.transactions.size())("h", header_hashes.count() / rounds)("m", merkle_roots.count() / rounds) );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
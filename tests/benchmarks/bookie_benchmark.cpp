@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/bookie/bookie_objects.hpp>
+
+#include "bench_report.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+using graphene::bookie::detail::event_name_index;
+
+BOOST_AUTO_TEST_SUITE( bookie_benchmarks )
+
+/**
+ * Fills the event name search index with a large catalogue of made up fixtures, then times substring and prefix
+ * searches that each ask for the first page of results.
+ */
+BOOST_AUTO_TEST_CASE( event_name_search_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t event_count = 200000;
+#else
+      const uint32_t event_count = 20000;
+#endif
+      const uint32_t query_count = 1000;
+      const size_t page_size = 20;
+
+      event_name_index index;
+      for( uint32_t i = 0; i < event_count; ++i )
+      {
+         event_object event;
+         event.id = event_id_type( i );
+         event.name["en"] = "Team " + fc::to_string( uint64_t( i ) ) + "/Club " +
+                            fc::to_string( uint64_t( (uint64_t( i ) * 7919) % event_count ) );
+         index.object_inserted( event );
+      }
+
+      std::vector<std::string> sub_strings;
+      for( uint32_t i = 0; i < query_count; ++i )
+         sub_strings.push_back( fc::to_string( (uint64_t( i ) * 104729) % event_count ) + "/club" );
+
+      size_t found = 0;
+      bench_recorder contains( "event_name_sub_string_search" );
+      contains.push_ops( query_count, [&]() {
+         for( const std::string& sub_string : sub_strings )
+            found += index.find_containing( "en", sub_string, page_size ).size();
+      });
+      contains.report();
+      BOOST_CHECK_GE( found, query_count );
+
+      found = 0;
+      bench_recorder prefix( "event_name_prefix_search" );
+      prefix.push_ops( query_count, [&]() {
+         for( uint32_t i = 0; i < query_count; ++i )
+            found += index.find_starting_with( "en", "team " + fc::to_string( uint64_t( i % 100 ) ), page_size ).size();
+      });
+      prefix.report();
+      BOOST_CHECK_GE( found, query_count );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
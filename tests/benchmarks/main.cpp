@@ -23,3 +23,40 @@
  */
 #define BOOST_TEST_MODULE "C++ Benchmarks for Graphene Blockchain Database"
 #include <boost/test/included/unit_test.hpp>
+
+#include "bench_report.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// count every heap allocation, so that workloads can report how much they allocate
+static std::atomic<uint64_t> heap_allocations( 0 );
+
+void* operator new( std::size_t size )
+{
+   heap_allocations.fetch_add( 1, std::memory_order_relaxed );
+   if( void* p = std::malloc( size ? size : 1 ) )
+      return p;
+   throw std::bad_alloc();
+}
+
+void operator delete( void* p ) noexcept
+{
+   std::free( p );
+}
+
+namespace graphene { namespace chain { namespace test {
+
+uint64_t allocation_count()
+{
+   return heap_allocations.load( std::memory_order_relaxed );
+}
+
+} } }
+
+struct bench_report_writer
+{
+   ~bench_report_writer() { graphene::chain::test::write_bench_report(); }
+};
+BOOST_GLOBAL_FIXTURE( bench_report_writer );
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+BOOST_FIXTURE_TEST_SUITE( object_database_benchmarks, database_fixture )
+
+/**
+ * Saves a chain state with many accounts and times loading it back into a fresh object database,
+ * serially and with a growing number of load threads.
+ */
+BOOST_AUTO_TEST_CASE( object_database_open_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t account_count = 20000;
+#else
+      const uint32_t account_count = 2000;
+#endif
+      for( uint32_t i = 0; i < account_count; ++i )
+         create_account( "loadbench" + fc::to_string(i) );
+      generate_block();
+
+      db.flush();
+      const auto expected = db.get_index_type<account_index>().indices().size();
+
+      for( uint32_t threads : { 0, 1, 2, 4, 8 } )
+      {
+         database loaded;
+         loaded.set_load_threads( threads );
+         auto start = fc::time_point::now();
+         loaded.object_database::open( data_dir->path() );
+         auto elapsed = fc::time_point::now() - start;
+
+         BOOST_CHECK_EQUAL( loaded.get_index_type<account_index>().indices().size(), expected );
+         BOOST_CHECK( loaded.get_index_type<account_index>().get_next_id() == db.get_index_type<account_index>().get_next_id() );
+         ilog( "${n} accounts, ${t} load threads: object database opened in ${ms} ms",
+               ("n", expected)("t", threads)("ms", elapsed.count() / 1000) );
+      }
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/proposal_object.hpp>
+
+#include "../common/database_fixture.hpp"
+#include "bench_report.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( proposal_benchmarks, database_fixture )
+
+/**
+ * Checks fresh proposals for duplicates against thousands of open proposals, each of them proposing
+ * a nested proposal of its own, as the network broadcast API does for every transaction it receives.
+ */
+BOOST_AUTO_TEST_CASE( duplicate_proposal_check_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t open_proposals = 5000;
+      const uint32_t checks = 5000;
+#else
+      const uint32_t open_proposals = 1000;
+      const uint32_t checks = 500;
+#endif
+
+      ACTORS((alice));
+
+      auto make_proposal = [&]( uint32_t amount ) -> proposal_create_operation {
+         transfer_operation transfer;
+         transfer.from = account_id_type();
+         transfer.to = alice_id;
+         transfer.amount = asset( amount );
+
+         proposal_create_operation proposal;
+         proposal.proposed_ops.push_back( op_wrapper( transfer ) );
+         return proposal;
+      };
+
+      for( uint32_t i = 0; i < open_proposals; ++i )
+      {
+         transaction proposed;
+         proposed.operations.push_back( make_proposal( i + 1 ) );
+         db.create<proposal_object>( [&]( proposal_object& p ) {
+            p.expiration_time = db.head_block_time() + fc::days(1);
+            p.proposed_transaction = proposed;
+         });
+      }
+
+      vector<signed_transaction> candidates( checks );
+      for( uint32_t i = 0; i < checks; ++i )
+         candidates[i].operations.push_back( make_proposal( open_proposals + i + 1 ) );
+
+      bench_recorder recorder( "duplicate_proposal_check" );
+      recorder.push_ops( checks, [&]() {
+         for( const signed_transaction& trx : candidates )
+            db.check_tansaction_for_duplicated_operations( trx );
+      });
+      recorder.report();
+
+      signed_transaction duplicate;
+      duplicate.operations.push_back( make_proposal( open_proposals ) );
+      BOOST_CHECK_THROW( db.check_tansaction_for_duplicated_operations( duplicate ), fc::exception );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+BOOST_FIXTURE_TEST_SUITE( signature_recovery_benchmarks, database_fixture )
+
+/**
+ * Pushes a block full of signed transfers with full signature validation, once with serial
+ * signature recovery and once per configured number of recovery threads.
+ */
+BOOST_AUTO_TEST_CASE( transfer_block_signature_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t transfer_count = 2000;
+#else
+      const uint32_t transfer_count = 200;
+#endif
+      const uint32_t rounds = 5;
+
+      vector<fc::ecc::private_key> keys;
+      vector<account_id_type> accounts;
+      for( uint32_t i = 0; i < transfer_count; ++i )
+      {
+         keys.push_back( generate_private_key( "sigbench" + fc::to_string(i) ) );
+         accounts.push_back( create_account( "sigbench" + fc::to_string(i), keys.back().get_public_key() ).id );
+         transfer( committee_account, accounts.back(), asset(100000) );
+      }
+      generate_block();
+
+      for( uint32_t i = 0; i < transfer_count; ++i )
+      {
+         signed_transaction tx;
+         transfer_operation op;
+         op.from = accounts[i];
+         op.to = accounts[(i + 1) % transfer_count];
+         op.amount = asset(1);
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         sign( tx, keys[i] );
+         PUSH_TX( db, tx, ~0 );
+      }
+      signed_block b = generate_block();
+      BOOST_REQUIRE_EQUAL( b.transactions.size(), transfer_count );
+
+      for( uint32_t threads : { 0, 1, 2, 4, 8 } )
+      {
+         db.set_signature_recovery_threads( threads );
+         auto start = fc::time_point::now();
+         for( uint32_t r = 0; r < rounds; ++r )
+         {
+            db.pop_block();
+            db.push_block( b, database::skip_witness_signature );
+         }
+         auto elapsed = fc::time_point::now() - start;
+         ilog( "${n} transfers per block, ${t} recovery threads: ${us} us/block, ${tps} trx/s",
+               ("n", transfer_count)("t", threads)("us", elapsed.count() / rounds)
+               ("tps", uint64_t(transfer_count) * rounds * 1000000 / std::max<int64_t>( elapsed.count(), 1 )) );
+         BOOST_CHECK( db.head_block_id() == b.id() );
+      }
+      db.set_signature_recovery_threads( 0 );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/tournament_object.hpp>
+#include <graphene/chain/game_object.hpp>
+
+#include "../common/tournament_helper.hpp"
+#include "bench_report.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( tournament_benchmarks, database_fixture )
+
+/**
+ * Fills a batch of four player rock-paper-scissors tournaments, then lets every game time out without a
+ * single move, so the chain picks the moves and plays the tournaments to their end.
+ */
+BOOST_AUTO_TEST_CASE( tournament_registration_and_timeout_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t tournament_count = 100;
+#else
+      const uint32_t tournament_count = 10;
+#endif
+      const uint32_t players_per_tournament = 4;
+      const uint32_t max_blocks = 2000;
+
+      ACTORS((nathan));
+      transfer( committee_account, nathan_id, asset(1000000000) );
+      upgrade_to_lifetime_member( nathan );
+
+      vector<account_id_type> players;
+      vector<fc::ecc::private_key> player_keys;
+      for( uint32_t i = 0; i < players_per_tournament; ++i )
+      {
+         player_keys.push_back( generate_private_key( "player" + fc::to_string(i) ) );
+         players.push_back( create_account( "player" + fc::to_string(i), player_keys.back().get_public_key() ).id );
+         transfer( committee_account, players.back(), asset(1000000000) );
+      }
+      generate_block();
+
+      tournaments_helper tournament_helper( *this );
+      const asset buy_in( 10000 );
+      vector<tournament_id_type> tournaments;
+      for( uint32_t t = 0; t < tournament_count; ++t )
+         tournaments.push_back( tournament_helper.create_tournament( nathan_id, nathan_private_key, buy_in,
+                                                                     players_per_tournament, 3, 1, 1 ) );
+      generate_block();
+
+      bench_recorder registration( "tournament_registration" );
+      registration.push_ops( tournament_count * players_per_tournament, [&]() {
+         for( const tournament_id_type& tournament_id : tournaments )
+            for( uint32_t i = 0; i < players_per_tournament; ++i )
+               tournament_helper.join_tournament( tournament_id, players[i], players[i], player_keys[i], buy_in );
+      });
+      registration.apply_block( tournament_count * players_per_tournament, [&]() { generate_block(); } );
+      registration.report();
+
+      auto all_concluded = [&]() {
+         for( const tournament_id_type& tournament_id : tournaments )
+            if( tournament_id(db).get_state() != tournament_state::concluded )
+               return false;
+         return true;
+      };
+
+      bench_recorder timeouts( "tournament_match_and_game_timeouts" );
+      uint32_t blocks = 0;
+      while( !all_concluded() && blocks < max_blocks )
+      {
+         timeouts.apply_block( 0, [&]() { generate_block(); } );
+         ++blocks;
+      }
+      BOOST_REQUIRE( all_concluded() );
+      // every game was ended by a timeout
+      timeouts.count_ops( db.get_index_type<game_index>().indices().size() );
+      timeouts.report();
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/global_property_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+BOOST_FIXTURE_TEST_SUITE( undo_benchmarks, database_fixture )
+
+/**
+ * Simulates the undo traffic of a block: one session per transaction merged into a
+ * per-block session, touching account statistics and the dynamic global properties.
+ */
+BOOST_AUTO_TEST_CASE( undo_session_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t account_count = 2000;
+      const uint32_t blocks = 2000;
+#else
+      const uint32_t account_count = 200;
+      const uint32_t blocks = 200;
+#endif
+      const uint32_t trx_per_block = 50;
+
+      vector<account_id_type> accounts;
+      for( uint32_t i = 0; i < account_count; ++i )
+         accounts.push_back( create_account( "bench" + fc::to_string(i) ).id );
+
+      const auto& pool = db._undo_db.object_pool();
+      uint64_t hits = pool.hits();
+      uint64_t misses = pool.misses();
+
+      auto start = fc::time_point::now();
+      for( uint32_t b = 0; b < blocks; ++b )
+      {
+         auto block_session = db._undo_db.start_undo_session();
+         for( uint32_t t = 0; t < trx_per_block; ++t )
+         {
+            auto trx_session = db._undo_db.start_undo_session();
+            const account_object& acct = accounts[(b * trx_per_block + t) % account_count](db);
+            db.modify( acct.statistics(db), [&]( account_statistics_object& s ) {
+               ++s.total_ops;
+            });
+            db.modify( db.get_dynamic_global_properties(), [&]( dynamic_global_property_object& p ) {
+               ++p.current_aslot;
+            });
+            trx_session.merge();
+         }
+         block_session.undo();
+      }
+      auto elapsed = fc::time_point::now() - start;
+
+      ilog( "Applied ${b} blocks of ${t} undo sessions in ${ms} ms (${us} us/block)",
+            ("b", blocks)("t", trx_per_block)("ms", elapsed.count() / 1000)("us", elapsed.count() / blocks) );
+      ilog( "Undo pre-image copies: ${h} reused from pool, ${m} newly allocated",
+            ("h", pool.hits() - hits)("m", pool.misses() - misses) );
+      BOOST_CHECK( pool.hits() - hits > pool.misses() - misses );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
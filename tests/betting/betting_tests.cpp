@@ -240,6 +240,23 @@ using namespace graphene::chain::keywords;
   const betting_market_object& cilic_wins_final_market = *db.get_index_type<betting_market_object_index>().indices().get<by_id>().rbegin(); \
   (void)federer_wins_market;(void)cilic_wins_market;(void)federer_wins_final_market; (void)cilic_wins_final_market; (void)berdych_wins_market; (void)querrey_wins_market;
 
+/**
+ * The reference for the order book: the bets a taker would be matched against, found by walking the opposite
+ * side of the by_odds index up to the taker's odds, with the amount each of them still has to bet.
+ */
+static vector<std::pair<bet_id_type, share_type>> makers_by_odds(const database& db, betting_market_id_type betting_market_id,
+                                                                 bet_type taker_back_or_lay, bet_multiplier_type taker_multiplier)
+{
+   const bet_type maker_back_or_lay = taker_back_or_lay == bet_type::back ? bet_type::lay : bet_type::back;
+   const auto& bet_odds_idx = db.get_index_type<bet_object_index>().indices().get<by_odds>();
+   auto book_itr = bet_odds_idx.lower_bound(std::make_tuple(betting_market_id, maker_back_or_lay));
+   auto book_end = bet_odds_idx.upper_bound(std::make_tuple(betting_market_id, maker_back_or_lay, taker_multiplier));
+   vector<std::pair<bet_id_type, share_type>> makers;
+   for (; book_itr != book_end; ++book_itr)
+      makers.emplace_back(book_itr->id, book_itr->amount_to_bet.amount);
+   return makers;
+}
+
 BOOST_FIXTURE_TEST_SUITE( betting_tests, database_fixture )
 
 BOOST_AUTO_TEST_CASE(try_create_sport)
@@ -423,6 +440,102 @@ BOOST_AUTO_TEST_CASE(binned_order_books)
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE(binned_order_book_updates)
+{
+   try
+   {
+      ACTORS( (alice)(bob) );
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+
+      transfer(account_id_type(), alice_id, asset(10000));
+      transfer(account_id_type(), bob_id, asset(10000));
+      generate_block();
+
+      graphene::bookie::bookie_api bookie_api(app);
+      // updates are sent from a task queued on this thread; tasks run in the order they were queued, so
+      // waiting for one queued after them waits until they are sent, or known not to be
+      auto wait_for_updates = []() { fc::async([](){}, "wait for order book updates").wait(); };
+      std::vector<graphene::bookie::binned_order_book_update> updates;
+      bookie_api.subscribe_to_binned_order_book([&updates](const fc::variant& update) {
+         updates.push_back(update.as<graphene::bookie::binned_order_book_update>());
+      }, capitals_win_market.id, 1);
+
+      // both back bets fall into the 1.7 bin
+      place_bet(bob_id, capitals_win_market.id, bet_type::back, asset(100, asset_id_type()), 165 * GRAPHENE_BETTING_ODDS_PRECISION / 100);
+      place_bet(bob_id, capitals_win_market.id, bet_type::back, asset(100, asset_id_type()), 167 * GRAPHENE_BETTING_ODDS_PRECISION / 100);
+      generate_block();
+      wait_for_updates();
+
+      BOOST_REQUIRE_EQUAL(updates.size(), 1u);
+      BOOST_CHECK(updates[0].betting_market_id == capitals_win_market.id);
+      BOOST_CHECK_EQUAL(updates[0].precision, 1);
+      BOOST_REQUIRE_EQUAL(updates[0].back_bins.size(), 1u);
+      BOOST_CHECK_EQUAL(updates[0].back_bins[0].backer_multiplier, 17 * GRAPHENE_BETTING_ODDS_PRECISION / 10);
+      BOOST_CHECK_EQUAL(updates[0].back_bins[0].amount_to_bet.value, 200);
+      BOOST_CHECK(updates[0].lay_bins.empty());
+
+      // a block that leaves the book alone sends nothing
+      generate_block();
+      wait_for_updates();
+      BOOST_CHECK_EQUAL(updates.size(), 1u);
+
+      // matching the whole bin empties it
+      share_type lay_amount = bet_object::get_approximate_matching_amount(200, 17 * GRAPHENE_BETTING_ODDS_PRECISION / 10, bet_type::back, true /* round up */);
+      place_bet(alice_id, capitals_win_market.id, bet_type::lay, asset(lay_amount, asset_id_type()), 17 * GRAPHENE_BETTING_ODDS_PRECISION / 10);
+      generate_block();
+      wait_for_updates();
+
+      BOOST_REQUIRE_EQUAL(updates.size(), 2u);
+      BOOST_REQUIRE_EQUAL(updates[1].back_bins.size(), 1u);
+      BOOST_CHECK_EQUAL(updates[1].back_bins[0].backer_multiplier, 17 * GRAPHENE_BETTING_ODDS_PRECISION / 10);
+      BOOST_CHECK_EQUAL(updates[1].back_bins[0].amount_to_bet.value, 0);
+      BOOST_CHECK(bookie_api.get_binned_order_book(capitals_win_market.id, 1).aggregated_back_bets.empty());
+
+      bookie_api.unsubscribe_from_binned_order_book(capitals_win_market.id, 1);
+      place_bet(bob_id, capitals_win_market.id, bet_type::back, asset(100, asset_id_type()), 165 * GRAPHENE_BETTING_ODDS_PRECISION / 100);
+      generate_block();
+      wait_for_updates();
+      BOOST_CHECK_EQUAL(updates.size(), 2u);
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE(event_name_search)
+{
+   try
+   {
+      CREATE_TENNIS_BETTING_MARKET();
+      generate_block();
+
+      graphene::bookie::bookie_api bookie_api(app);
+
+      std::vector<event_object> events = bookie_api.get_events_containing_sub_string("federer", "en");
+      BOOST_REQUIRE_EQUAL(events.size(), 2u);
+      BOOST_CHECK(events[0].id == berdych_vs_federer.id);
+      BOOST_CHECK(events[1].id == cilic_vs_federer.id);
+
+      // substrings shorter and longer than a trigram, and one no event name contains
+      BOOST_CHECK_EQUAL(bookie_api.get_events_with_name_containing("CI", "en", 10).size(), 2u);
+      BOOST_CHECK_EQUAL(bookie_api.get_events_with_name_containing("erer/t", "en", 10).size(), 1u);
+      BOOST_CHECK_EQUAL(bookie_api.get_events_with_name_containing("federer/s", "en", 10).size(), 0u);
+      BOOST_CHECK_EQUAL(bookie_api.get_events_with_name_containing("federer", "en", 1).size(), 1u);
+      BOOST_CHECK_EQUAL(bookie_api.get_events_with_name_containing("federer", "de", 10).size(), 0u);
+
+      events = bookie_api.get_events_with_name_starting_with("r. federer", "en", 10);
+      BOOST_REQUIRE_EQUAL(events.size(), 2u);
+      BOOST_CHECK(events[0].id == cilic_vs_federer.id);
+      BOOST_CHECK(events[1].id == berdych_vs_federer.id);
+
+      // renamed events are found by their new name only
+      fc::optional<internationalized_string_type> new_name = internationalized_string_type({{"en", "M. Cilic/R. Nadal"}});
+      update_event(cilic_vs_querrey.id, _name = new_name);
+      generate_block();
+      BOOST_CHECK_EQUAL(bookie_api.get_events_with_name_containing("querrye", "en", 10).size(), 0u);
+      events = bookie_api.get_events_with_name_containing("nadal", "en", 10);
+      BOOST_REQUIRE_EQUAL(events.size(), 1u);
+      BOOST_CHECK(events[0].id == cilic_vs_querrey.id);
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE( peerplays_sport_create_test )
 {
    try
@@ -906,6 +1019,141 @@ BOOST_AUTO_TEST_CASE(bet_reversal_test)
    FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE(order_book_matches_by_odds_test)
+{
+   // the order book used for matching must agree with the by_odds index, also after bets are restored by undo
+   try
+   {
+      generate_blocks(1);
+      ACTORS( (alice)(bob) );
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+
+      transfer(account_id_type(), alice_id, asset(10000000));
+      transfer(account_id_type(), bob_id, asset(10000000));
+
+      const auto& bet_idx = db.get_index_type<bet_object_index>();
+      const auto& order_book = dynamic_cast<const primary_index<bet_object_index>&>(bet_idx).get_secondary_index<bet_order_book_index>();
+      const auto& bet_odds_idx = bet_idx.indices().get<by_odds>();
+      auto check_best_match = [&](bet_type type_to_match, bet_multiplier_type backer_multiplier) {
+         auto book_itr = bet_odds_idx.lower_bound(std::make_tuple(capitals_win_market.id, type_to_match));
+         auto book_end = bet_odds_idx.upper_bound(std::make_tuple(capitals_win_market.id, type_to_match, backer_multiplier));
+         optional<bet_id_type> best = order_book.best_match(capitals_win_market.id, type_to_match, backer_multiplier);
+         if (book_itr == book_end)
+            BOOST_CHECK(!best);
+         else
+         {
+            BOOST_REQUIRE(best);
+            BOOST_CHECK(*best == book_itr->id);
+         }
+      };
+
+      place_bet(bob_id, capitals_win_market.id, bet_type::lay, asset(1000, asset_id_type()), 3 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_bet(bob_id, capitals_win_market.id, bet_type::lay, asset(1000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_bet(bob_id, capitals_win_market.id, bet_type::lay, asset(2000, asset_id_type()), 3 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_bet(alice_id, capitals_win_market.id, bet_type::back, asset(1000, asset_id_type()), 4 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_bet(alice_id, capitals_win_market.id, bet_type::back, asset(1000, asset_id_type()), 5 * GRAPHENE_BETTING_ODDS_PRECISION);
+
+      check_best_match(bet_type::lay, 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      check_best_match(bet_type::lay, 3 * GRAPHENE_BETTING_ODDS_PRECISION);
+      check_best_match(bet_type::lay, 4 * GRAPHENE_BETTING_ODDS_PRECISION);
+      check_best_match(bet_type::back, 3 * GRAPHENE_BETTING_ODDS_PRECISION);
+      check_best_match(bet_type::back, 4 * GRAPHENE_BETTING_ODDS_PRECISION);
+      check_best_match(bet_type::back, 5 * GRAPHENE_BETTING_ODDS_PRECISION);
+
+      // this bet matches the lay bets before failing the balance check, so they are removed and restored by undo
+      BOOST_CHECK_THROW( place_bet(alice_id, capitals_win_market.id, bet_type::back, asset(20000000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION), fc::exception);
+      trx.operations.clear();
+      check_best_match(bet_type::lay, 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      check_best_match(bet_type::lay, 3 * GRAPHENE_BETTING_ODDS_PRECISION);
+
+      // now match the best lay bets for real
+      place_bet(alice_id, capitals_win_market.id, bet_type::back, asset(2000, asset_id_type()), 3 * GRAPHENE_BETTING_ODDS_PRECISION);
+      check_best_match(bet_type::lay, 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      check_best_match(bet_type::lay, 3 * GRAPHENE_BETTING_ODDS_PRECISION);
+      generate_blocks(1);
+      check_best_match(bet_type::lay, 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      check_best_match(bet_type::back, 5 * GRAPHENE_BETTING_ODDS_PRECISION);
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE(order_book_fills_follow_by_odds_scan_test)
+{
+   // every taker must be matched against the makers a walk of the by_odds index finds, in that order,
+   // consuming each of them completely before going on to the next
+   try
+   {
+      generate_blocks(1);
+      ACTORS( (alice)(bob)(carol) );
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+
+      transfer(account_id_type(), alice_id, asset(10000000));
+      transfer(account_id_type(), bob_id, asset(10000000));
+      transfer(account_id_type(), carol_id, asset(10000000));
+      generate_blocks(1);
+
+      const int bet_matched_type = operation::tag<bet_matched_operation>::value;
+      const int bet_adjusted_type = operation::tag<bet_adjusted_operation>::value;
+      uint32_t fills = 0;
+      uint32_t refunds = 0;
+      auto place_and_check = [&](account_id_type bettor_id, bet_type back_or_lay, share_type amount, bet_multiplier_type backer_multiplier) {
+         const vector<std::pair<bet_id_type, share_type>> expected =
+               makers_by_odds(db, capitals_win_market.id, back_or_lay, backer_multiplier);
+         const size_t ops_before = db.get_applied_operations().size();
+         const bet_id_type taker_id = place_bet(bettor_id, capitals_win_market.id, back_or_lay, asset(amount, asset_id_type()), backer_multiplier);
+
+         vector<std::pair<bet_id_type, share_type>> makers;
+         const auto& ops = db.get_applied_operations();
+         for (size_t i = ops_before; i < ops.size(); ++i)
+            if (ops[i].valid() && ops[i]->op.which() == bet_matched_type)
+            {
+               const bet_matched_operation& matched = ops[i]->op.get<bet_matched_operation>();
+               if (matched.bet_id != taker_id)
+                  makers.emplace_back(matched.bet_id, matched.amount_bet.amount);
+            }
+            else if (ops[i].valid() && ops[i]->op.which() == bet_adjusted_type)
+               ++refunds;
+         fills += makers.size();
+
+         BOOST_REQUIRE(makers.size() <= expected.size());
+         for (size_t i = 0; i < makers.size(); ++i)
+         {
+            BOOST_CHECK(makers[i].first == expected[i].first);
+            if (i + 1 < makers.size())
+            {
+               BOOST_CHECK_EQUAL(makers[i].second.value, expected[i].second.value);
+               BOOST_CHECK(db.find(makers[i].first) == nullptr);
+            }
+         }
+         // a taker left on the books has taken every maker it crosses
+         if (db.find(taker_id))
+            BOOST_CHECK_EQUAL(makers.size(), expected.size());
+      };
+
+      // several makers per price level, takers that sweep levels, odds that leave remainders to refund
+      place_and_check(bob_id, bet_type::lay, 1000, 3 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_and_check(bob_id, bet_type::lay, 1000, 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_and_check(carol_id, bet_type::lay, 2000, 3 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_and_check(carol_id, bet_type::lay, 1500, 25 * GRAPHENE_BETTING_ODDS_PRECISION / 10);
+      place_and_check(bob_id, bet_type::lay, 777, 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_and_check(alice_id, bet_type::back, 3001, 25 * GRAPHENE_BETTING_ODDS_PRECISION / 10);
+      place_and_check(alice_id, bet_type::back, 1234, 4 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_and_check(alice_id, bet_type::back, 777, 5 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_and_check(bob_id, bet_type::back, 500, 3 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_and_check(carol_id, bet_type::lay, 10001, 4 * GRAPHENE_BETTING_ODDS_PRECISION);
+      BOOST_CHECK_THROW( place_bet(alice_id, capitals_win_market.id, bet_type::back, asset(20000000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION), fc::exception);
+      trx.operations.clear();
+      place_and_check(alice_id, bet_type::back, 20000, 25 * GRAPHENE_BETTING_ODDS_PRECISION / 10);
+      place_and_check(bob_id, bet_type::lay, 3333, 5 * GRAPHENE_BETTING_ODDS_PRECISION);
+      generate_blocks(1);
+
+      // the sequence has to exercise sweeps, partial fills and refunds to be worth checking
+      BOOST_CHECK_GT(fills, 4u);
+      BOOST_CHECK_GT(refunds, 0u);
+   }
+   FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE(bet_against_exposure_test)
 {
    // test whether we can bet our entire balance in one direction, have it match, then reverse our bet (while having zero balance)
@@ -1175,6 +1423,49 @@ BOOST_AUTO_TEST_CASE(delayed_bets_test) // test live betting
    FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE(delayed_bets_on_frozen_market_test)
+{
+   try
+   {
+      ACTORS( (alice)(bob) );
+
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+
+      generate_blocks(1);
+
+      update_betting_market_group(moneyline_betting_markets.id, _status = betting_market_group_status::in_play);
+      generate_blocks(1);
+
+      transfer(account_id_type(), alice_id, asset(10000000));
+      transfer(account_id_type(), bob_id, asset(10000000));
+      generate_blocks(1);
+
+      BOOST_TEST_MESSAGE("Alice and Bob place delayed bets on different markets");
+      bet_id_type alice_bet = place_bet(alice_id, capitals_win_market.id, bet_type::back, asset(100, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      bet_id_type bob_bet = place_bet(bob_id, blackhawks_win_market.id, bet_type::back, asset(100, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      generate_blocks(1);
+      BOOST_REQUIRE(alice_bet(db).end_of_delay);
+      BOOST_REQUIRE(bob_bet(db).end_of_delay);
+
+      BOOST_TEST_MESSAGE("Freezing the markets before the delays end");
+      update_betting_market_group(moneyline_betting_markets.id, _status = betting_market_group_status::frozen);
+      generate_blocks(3);
+
+      // the delays have ended, but the bets stay out of the books while their markets are frozen
+      BOOST_CHECK(alice_bet(db).end_of_delay);
+      BOOST_CHECK(bob_bet(db).end_of_delay);
+
+      BOOST_TEST_MESSAGE("Unfreezing the markets");
+      update_betting_market_group(moneyline_betting_markets.id, _status = betting_market_group_status::in_play);
+      generate_blocks(1);
+
+      BOOST_CHECK(!alice_bet(db).end_of_delay);
+      BOOST_CHECK(!bob_bet(db).end_of_delay);
+      BOOST_CHECK(db.get_index_type<bet_object_index>().indices().get<by_odds>().size() == 2);
+   }
+   FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE( chained_market_create_test )
 {
    // Often you will want to create several objects that reference each other at the same time.
@@ -1377,6 +1668,75 @@ BOOST_AUTO_TEST_CASE( cancel_one_event_in_group )
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( parallel_settlement_matches_serial )
+{
+   // settles the same block serially and with several settlement threads, and checks that the
+   // balances, the rake and the virtual operations come out the same every time
+   try
+   {
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+      const betting_market_group_id_type group_id = moneyline_betting_markets.id;
+
+      vector<account_id_type> bettors;
+      for (uint32_t i = 0; i < 12; ++i)
+      {
+         bettors.push_back(create_account("settler" + fc::to_string(i)).id);
+         transfer(account_id_type(), bettors.back(), asset(100000));
+      }
+      generate_blocks(1);
+
+      // bettors are paired up on both markets at several odds with uneven amounts, so some bets are only
+      // partially matched and the bettors end up with different payouts
+      for (uint32_t i = 0; i < bettors.size(); ++i)
+         place_bet(bettors[i], (i / 2) % 2 ? blackhawks_win_market.id : capitals_win_market.id,
+                   i % 2 ? bet_type::lay : bet_type::back, asset(1000 + 300 * i, asset_id_type()),
+                   (2 + (i / 2) % 3) * GRAPHENE_BETTING_ODDS_PRECISION);
+      generate_blocks(1);
+      BOOST_REQUIRE(!db.get_index_type<betting_market_position_index>().indices().empty());
+
+      vector<vector<char>> settled_ops;
+      uint32_t resolved_ops = 0;
+      boost::signals2::scoped_connection connection = db.applied_block.connect([&](const signed_block&) {
+         settled_ops.clear();
+         resolved_ops = 0;
+         for (const optional<operation_history_object>& o : db.get_applied_operations())
+            if (o.valid())
+            {
+               settled_ops.push_back(fc::raw::pack(*o));
+               if (o->op.which() == operation::tag<betting_market_group_resolved_operation>::value)
+                  ++resolved_ops;
+            }
+      });
+      auto current_balances = [&]() -> std::map<std::pair<account_id_type, asset_id_type>, share_type> {
+         std::map<std::pair<account_id_type, asset_id_type>, share_type> result;
+         for (const account_balance_object& balance : db.get_index_type<account_balance_index>().indices())
+            result[std::make_pair(balance.owner, balance.asset_type)] = balance.balance;
+         return result;
+      };
+
+      resolve_betting_market_group(group_id, {{capitals_win_market.id, betting_market_resolution_type::win},
+                                              {blackhawks_win_market.id, betting_market_resolution_type::not_win}});
+      signed_block b = generate_block();
+      BOOST_REQUIRE(db.find(group_id) == nullptr);
+      BOOST_CHECK_EQUAL(resolved_ops, bettors.size());
+      const auto serial_balances = current_balances();
+      const vector<vector<char>> serial_ops = settled_ops;
+
+      for (uint32_t threads : {1, 2, 4})
+      {
+         BOOST_TEST_MESSAGE("Settling with " + fc::to_string(threads) + " settlement threads");
+         db.pop_block();
+         db.set_settlement_threads(threads);
+         db.push_block(b, database::skip_witness_signature);
+         BOOST_CHECK(db.head_block_id() == b.id());
+         BOOST_CHECK(db.find(group_id) == nullptr);
+         BOOST_CHECK(current_balances() == serial_balances);
+         BOOST_CHECK(settled_ops == serial_ops);
+      }
+      db.set_settlement_threads(0);
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_FIXTURE_TEST_SUITE( simple_bet_tests, simple_bet_test_fixture )
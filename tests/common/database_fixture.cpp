@@ -67,6 +67,11 @@ using std::cout;
 using std::cerr;
 
 database_fixture::database_fixture()
+   : database_fixture( boost::program_options::variables_map() )
+{
+}
+
+database_fixture::database_fixture( const boost::program_options::variables_map& plugin_options )
    : app(), db( *app.chain_database() )
 {
    try {
@@ -87,7 +92,7 @@ database_fixture::database_fixture()
    auto affiliateplugin = app.register_plugin<graphene::affiliate_stats::affiliate_stats_plugin>();
    init_account_pub_key = init_account_priv_key.get_public_key();
 
-   boost::program_options::variables_map options;
+   boost::program_options::variables_map options = plugin_options;
 
    genesis_state.initial_timestamp = time_point_sec( GRAPHENE_TESTING_GENESIS_TIMESTAMP );
    //int back_to_the_past = 0;
@@ -176,6 +176,8 @@ struct database_fixture {
    uint32_t anon_acct_count;
 
    database_fixture();
+   /// @param plugin_options passed to plugin_initialize() of the built-in plugins
+   explicit database_fixture( const boost::program_options::variables_map& plugin_options );
    ~database_fixture();
 
    static fc::ecc::private_key generate_private_key(string seed);
@@ -24,6 +24,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <graphene/app/api.hpp>
+
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/exceptions.hpp>
 
@@ -126,6 +128,61 @@ BOOST_AUTO_TEST_CASE( block_database_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( block_database_view_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      block_database bdb;
+      bdb.open( data_dir.path() );
+      BOOST_CHECK( !bdb.begin().valid() );
+
+      vector<block_id_type> ids;
+      signed_block b;
+      for( uint32_t i = 0; i < 10; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         bdb.store( b.id(), b );
+         ids.push_back( b.id() );
+
+         // each store grows the files past the current mapping
+         block_view view = bdb.fetch_view( b.id() );
+         BOOST_REQUIRE( view.valid() );
+         BOOST_CHECK( view.id() == b.id() );
+         BOOST_CHECK( view.size() == fc::raw::pack_size( b ) );
+         BOOST_CHECK( view.unpack().witness == b.witness );
+      }
+
+      block_view held = bdb.fetch_view_by_number( 3 );
+      uint32_t num = 1;
+      for( auto itr = bdb.begin(); num <= 10; ++itr, ++num )
+      {
+         BOOST_REQUIRE( itr.valid() );
+         BOOST_CHECK_EQUAL( itr.block_num(), num );
+         BOOST_CHECK( itr->id() == ids[num-1] );
+         BOOST_CHECK( itr->unpack().witness == witness_id_type(num) );
+      }
+
+      bdb.remove( ids.back() );
+      BOOST_CHECK( !bdb.fetch_view( ids.back() ).valid() );
+      BOOST_CHECK( !bdb.begin( 10 ).valid() );
+      BOOST_CHECK( *bdb.last_id() == ids[8] );
+
+      // views outlive the mapping they were taken from
+      bdb.close();
+      BOOST_REQUIRE( held.valid() );
+      BOOST_CHECK( held.unpack().witness == witness_id_type(3) );
+
+      bdb.open( data_dir.path() );
+      BOOST_CHECK( bdb.fetch_view_by_number( 9 ).id() == ids[8] );
+      BOOST_CHECK( bdb.last()->id() == ids[8] );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( generate_empty_blocks )
 {
    try {
@@ -803,6 +860,41 @@ BOOST_FIXTURE_TEST_CASE( double_sign_check, database_fixture )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_FIXTURE_TEST_CASE( signature_key_cache, database_fixture )
+{ try {
+   generate_block();
+   const auto& alice = account_id_type()(db);
+   ACTOR(bob);
+   transfer( alice, bob, asset(1000) );
+   db.set_signature_recovery_threads( 2 );
+
+   set_expiration( db, trx );
+   transfer_operation t;
+   t.from = bob.id;
+   t.to = alice.id;
+   t.amount = asset(100);
+   trx.operations.push_back(t);
+   trx.validate();
+   sign( trx, bob_private_key );
+
+   auto before = db.get_signature_key_cache_stats();
+   db.push_transaction(trx, 0);
+   auto pushed = db.get_signature_key_cache_stats();
+   BOOST_CHECK_EQUAL( pushed.misses, before.misses + 1 );
+
+   BOOST_TEST_MESSAGE( "Verify that applying the transaction again inside a block reuses the recovered keys" );
+   signed_block b = generate_block();
+   BOOST_REQUIRE_EQUAL( b.transactions.size(), 1 );
+   db.pop_block();
+   db.push_block( b, database::skip_witness_signature );
+   auto applied = db.get_signature_key_cache_stats();
+   BOOST_CHECK_EQUAL( applied.misses, pushed.misses );
+   BOOST_CHECK( applied.hits > pushed.hits );
+   BOOST_CHECK( db.head_block_id() == b.id() );
+
+   db.set_signature_recovery_threads( 0 );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_FIXTURE_TEST_CASE( change_block_interval, database_fixture )
 { try {
    generate_block();
@@ -957,6 +1049,72 @@ BOOST_FIXTURE_TEST_CASE( witness_scheduler_missed_blocks, database_fixture )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_FIXTURE_TEST_CASE( scheduled_witnesses_batch, database_fixture )
+{ try {
+   uint8_t witness_schedule_algorithm = db.get_global_properties().parameters.witness_schedule_algorithm;
+   const uint32_t slots = 300;
+
+   // the schedule as it was worked out before the far future schedule was cached
+   auto expected_witnesses = [&]() -> vector<witness_id_type> {
+      const witness_schedule_object& wso = witness_schedule_id_type()(db);
+      vector<witness_id_type> result;
+      if( db.get_global_properties().parameters.witness_schedule_algorithm == GRAPHENE_WITNESS_SHUFFLED_ALGORITHM )
+      {
+         const uint64_t current_aslot = db.get_dynamic_global_properties().current_aslot;
+         for( uint32_t slot_num = 1; slot_num <= slots; ++slot_num )
+            result.push_back( wso.current_shuffled_witnesses[ ( current_aslot + slot_num ) % wso.current_shuffled_witnesses.size() ] );
+         return result;
+      }
+      far_future_witness_scheduler far_scheduler( wso.scheduler,
+                                                  witness_scheduler_rng( wso.rng_seed.begin(), GRAPHENE_FAR_SCHEDULE_CTR_IV ) );
+      for( uint32_t slot_num = 1; slot_num <= slots; ++slot_num )
+      {
+         witness_id_type wid;
+         if( !wso.scheduler.get_slot( slot_num - 1, wid ) )
+            far_scheduler.get_slot( slot_num - 1, wid );
+         result.push_back( wid );
+      }
+      return result;
+   };
+
+   auto check_batch = [&]() {
+      vector<witness_id_type> expected = expected_witnesses();
+      vector<witness_id_type> batch = db.get_scheduled_witnesses( 1, slots );
+      BOOST_REQUIRE_EQUAL( batch.size(), slots );
+      for( uint32_t i = 0; i < slots; ++i )
+      {
+         BOOST_CHECK( batch[i] == expected[i] );
+         BOOST_CHECK( db.get_scheduled_witness( i + 1 ) == expected[i] );
+      }
+   };
+
+   // far beyond the near schedule, so both lookups go through the cached far future schedule
+   for( uint8_t algorithm : { GRAPHENE_WITNESS_SCHEDULED_ALGORITHM, GRAPHENE_WITNESS_SHUFFLED_ALGORITHM } )
+   {
+      db.modify(db.get_global_properties(), [algorithm](global_property_object& p) {
+         p.parameters.witness_schedule_algorithm = algorithm;
+      });
+      check_batch();
+      // the schedule moves on with every block, the cached far future schedule must follow it
+      generate_block();
+      check_batch();
+      generate_block(0, init_account_priv_key, 20);
+      check_batch();
+      // and back when a block is popped
+      db.pop_block();
+      check_batch();
+      // and when the maintenance interval reshuffles the witnesses
+      generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+      check_batch();
+      generate_block();
+      check_batch();
+   }
+
+   db.modify(db.get_global_properties(), [&witness_schedule_algorithm](global_property_object& p) {
+      p.parameters.witness_schedule_algorithm = witness_schedule_algorithm;
+   });
+} FC_LOG_AND_RETHROW() }
+
 BOOST_FIXTURE_TEST_CASE( rsf_missed_blocks, database_fixture )
 {
    try
@@ -1304,4 +1462,45 @@ BOOST_FIXTURE_TEST_CASE( miss_many_blocks, database_fixture )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( get_raw_blocks, database_fixture )
+{
+   try
+   {
+      generate_blocks( 10 );
+      graphene::app::block_api block_api( db );
+
+      graphene::app::raw_block_range all = block_api.get_raw_blocks( 0, 1000 );
+      BOOST_REQUIRE_EQUAL( all.blocks.size(), db.head_block_num() );
+      BOOST_CHECK_EQUAL( all.next_block_num, db.head_block_num() + 1 );
+      for( const graphene::app::raw_block& raw : all.blocks )
+      {
+         signed_block block = fc::raw::unpack<signed_block>( raw.data );
+         BOOST_CHECK( block.id() == raw.id );
+         BOOST_CHECK( raw.id == db.get_block_id_for_num( raw.block_num ) );
+      }
+
+      // pages continue at the returned cursor until the head block is passed
+      vector<block_id_type> paged;
+      uint32_t block_num = 1;
+      for( ;; )
+      {
+         graphene::app::raw_block_range page = block_api.get_raw_blocks( block_num, 3 );
+         if( page.blocks.empty() )
+            break;
+         BOOST_CHECK_LE( page.blocks.size(), 3u );
+         for( const graphene::app::raw_block& raw : page.blocks )
+            paged.push_back( raw.id );
+         block_num = page.next_block_num;
+      }
+      BOOST_REQUIRE_EQUAL( paged.size(), all.blocks.size() );
+      for( size_t i = 0; i < paged.size(); ++i )
+         BOOST_CHECK( paged[i] == all.blocks[i].id );
+   }
+   catch (fc::exception& e)
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -24,6 +24,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <graphene/app/api.hpp>
 #include <graphene/app/database_api.hpp>
 
 #include "../common/database_fixture.hpp"
@@ -68,4 +69,40 @@ BOOST_FIXTURE_TEST_SUITE(database_api_tests, database_fixture)
       } FC_LOG_AND_RETHROW()
   }
 
+  BOOST_AUTO_TEST_CASE(asset_holders_count) {
+      try {
+          ACTORS((alice)(bob));
+          graphene::app::asset_api asset_api(db);
+          const asset_id_type token_id = create_user_issued_asset("TOKEN").id;
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count(token_id), 0);
+
+          issue_uia(alice_id, asset(100, token_id));
+          issue_uia(bob_id, asset(100, token_id));
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count(token_id), 2);
+
+          // an account whose balance drops to zero keeps its balance object but stops being a holder
+          transfer(alice_id, bob_id, asset(100, token_id));
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count(token_id), 1);
+          generate_block();
+
+          // balances of a popped block are counted as they were before it
+          transfer(bob_id, alice_id, asset(50, token_id));
+          generate_block();
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count(token_id), 2);
+          db.pop_block();
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count(token_id), 1);
+
+          bool found = false;
+          for (const graphene::app::asset_holders& holders : asset_api.get_all_asset_holders())
+          {
+              if (holders.asset_id != token_id)
+                  continue;
+              BOOST_CHECK_EQUAL(holders.count, 1);
+              found = true;
+          }
+          BOOST_CHECK(found);
+
+      } FC_LOG_AND_RETHROW()
+  }
+
 BOOST_AUTO_TEST_SUITE_END()
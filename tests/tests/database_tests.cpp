@@ -30,6 +30,10 @@
 
 #include <fc/crypto/digest.hpp>
 
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/io/json.hpp>
+
 #include "../common/database_fixture.hpp"
 
 using namespace graphene::chain;
@@ -59,3 +63,240 @@ BOOST_AUTO_TEST_CASE( undo_test )
       throw;
    }
 }
+
+BOOST_AUTO_TEST_CASE( undo_pool_test )
+{
+   try {
+      database db;
+      const auto& bal_obj = db.create<account_balance_object>( [&]( account_balance_object& obj ){
+         obj.balance = 1;
+      });
+      const auto& pool = db._undo_db.object_pool();
+
+      {
+         auto ses = db._undo_db.start_undo_session();
+         db.modify( bal_obj, [&]( account_balance_object& obj ){ obj.balance = 2; } );
+         BOOST_CHECK( bal_obj.balance == 2 );
+         ses.undo();
+      }
+      BOOST_CHECK( bal_obj.balance == 1 );
+      uint64_t misses = pool.misses();
+
+      // the pre-image discarded by the undo above is reused for the next session
+      {
+         auto ses = db._undo_db.start_undo_session();
+         db.modify( bal_obj, [&]( account_balance_object& obj ){ obj.balance = 3; } );
+         ses.undo();
+      }
+      BOOST_CHECK( bal_obj.balance == 1 );
+      BOOST_CHECK_EQUAL( pool.misses(), misses );
+      BOOST_CHECK( pool.hits() > 0 );
+
+      // a merged pre-image that is superseded by the outer session's copy goes back to the pool too
+      {
+         auto outer = db._undo_db.start_undo_session();
+         db.modify( bal_obj, [&]( account_balance_object& obj ){ obj.balance = 4; } );
+         {
+            auto inner = db._undo_db.start_undo_session();
+            db.modify( bal_obj, [&]( account_balance_object& obj ){ obj.balance = 5; } );
+            inner.merge();
+         }
+         outer.undo();
+      }
+      BOOST_CHECK( bal_obj.balance == 1 );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( index_file_format_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const fc::path index_file = data_dir.path() / "object_database"
+                                  / fc::to_string( uint32_t(account_balance_object::space_id) )
+                                  / fc::to_string( uint32_t(account_balance_object::type_id) );
+      {
+         database db;
+         db.object_database::open( data_dir.path() );
+         for( int64_t i = 0; i < 100; ++i )
+            db.create<account_balance_object>( [&]( account_balance_object& obj ){ obj.balance = i; } );
+         db.remove( db.get( account_balance_id_type(50) ) );
+         db.flush();
+      }
+
+      auto check_loaded = [&]( uint32_t threads ) {
+         database db;
+         db.set_load_threads( threads );
+         db.object_database::open( data_dir.path() );
+         const auto& idx = db.get_index_type<account_balance_index>();
+         BOOST_CHECK_EQUAL( idx.indices().size(), 99u );
+         BOOST_CHECK( idx.get_next_id() == account_balance_id_type(100) );
+         BOOST_CHECK( db.find( account_balance_id_type(50) ) == nullptr );
+         BOOST_CHECK( account_balance_id_type(99)(db).balance == 99 );
+      };
+      check_loaded( 0 );
+      check_loaded( 2 );
+
+      // files written in the format that predates index_file_header still load
+      {
+         database db;
+         db.object_database::open( data_dir.path() );
+         std::ofstream out( index_file.generic_string(), std::ofstream::binary | std::ofstream::trunc );
+         fc::raw::pack( out, db.get_index_type<account_balance_index>().get_next_id() );
+         fc::raw::pack( out, fc::sha256::hash( std::string("1.0") ) );
+         db.get_index_type<account_balance_index>().inspect_all_objects( [&]( const object& o ) {
+            fc::raw::pack( out, fc::raw::pack( static_cast<const account_balance_object&>(o) ) );
+         });
+      }
+      check_loaded( 0 );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( state_checkpoint_test, database_fixture )
+{
+   try {
+      const fc::path manifest_file = data_dir->path() / "state_checkpoint" / "manifest";
+      db.set_state_checkpoint_interval( 5 );
+      create_account( "checkpointed" );
+      for( uint32_t i = 0; i < 40; ++i )
+         generate_block();
+      db.wait_for_state_checkpoint();
+
+      BOOST_REQUIRE( fc::exists( manifest_file ) );
+      auto manifest = fc::json::from_file( manifest_file ).as<state_checkpoint_manifest>();
+      BOOST_CHECK_EQUAL( manifest.block_num % 5, 0u );
+      BOOST_CHECK( manifest.block_num <= db.get_dynamic_global_properties().last_irreversible_block_num );
+      BOOST_CHECK( db.get_block_id_for_num( manifest.block_num ) == manifest.block_id );
+      for( const auto& entry : manifest.indexes )
+         BOOST_CHECK( fc::exists( data_dir->path() / "state_checkpoint" / entry.file ) );
+
+      // a later checkpoint only rewrites the indexes that changed in between
+      const uint32_t previous_block_num = manifest.block_num;
+      for( uint32_t i = 0; i < 10; ++i )
+         generate_block();
+      db.wait_for_state_checkpoint();
+      auto next = fc::json::from_file( manifest_file ).as<state_checkpoint_manifest>();
+      BOOST_REQUIRE( next.block_num > previous_block_num );
+      uint32_t reused = 0;
+      for( const auto& entry : next.indexes )
+         for( const auto& old_entry : manifest.indexes )
+            if( entry.file == old_entry.file )
+               ++reused;
+      BOOST_CHECK( reused > 0 );
+      BOOST_CHECK( reused < next.indexes.size() );
+
+      database resumed;
+      BOOST_REQUIRE( resumed.open_from_state_checkpoint( data_dir->path() ) );
+      BOOST_CHECK( resumed.head_block_id() == db.head_block_id() );
+      BOOST_CHECK_EQUAL( resumed.get_index_type<account_index>().indices().get<by_name>().count( "checkpointed" ), 1u );
+      resumed.close( false );
+
+      // a file cut short by a crash is not used
+      const fc::path checkpoint_dir = data_dir->path() / "state_checkpoint";
+      state_checkpoint_file global_properties;
+      for( const auto& entry : next.indexes )
+         if( entry.space == implementation_ids && entry.type == impl_global_property_object_type )
+            global_properties = entry;
+      BOOST_REQUIRE( global_properties.size > 0 );
+      const auto overwrite = [&]( uint64_t size ) {
+         std::ofstream out( ( checkpoint_dir / global_properties.file ).generic_string(),
+                            std::ofstream::binary | std::ofstream::trunc );
+         out << std::string( size, '\0' );
+      };
+      overwrite( global_properties.size - 1 );
+      {
+         database truncated;
+         BOOST_CHECK( !truncated.open_from_state_checkpoint( data_dir->path() ) );
+         BOOST_CHECK( fc::exists( manifest_file ) );
+      }
+
+      // one that fails to load leaves no state behind, and the node falls back to a replay
+      overwrite( global_properties.size );
+      database corrupted;
+      BOOST_CHECK( !corrupted.open_from_state_checkpoint( data_dir->path() ) );
+      BOOST_CHECK( corrupted.find( global_property_id_type() ) == nullptr );
+      BOOST_CHECK( corrupted.find( account_id_type() ) == nullptr );
+      BOOST_CHECK( !fc::exists( manifest_file ) );
+      BOOST_CHECK( fc::exists( checkpoint_dir / "manifest.bad" ) );
+      corrupted.reindex( data_dir->path(), genesis_state );
+      BOOST_CHECK( corrupted.head_block_id() == db.head_block_id() );
+      BOOST_CHECK( corrupted._undo_db.enabled() );
+      corrupted.close( false );
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( change_journal_replay_test, database_fixture )
+{
+   try {
+      const account_id_type alice_id = create_account( "alice" ).id;
+      generate_block();
+      transfer( account_id_type(), alice_id, asset( 1000 ) );
+      generate_block();
+      db.close( false );
+
+      // replaying without undo history still reports the objects each block touched
+      database replayed;
+      std::set<object_id_type> created;
+      flat_set<account_id_type> changed_accounts;
+      replayed.connect_new_objects( [&]( const vector<object_id_type>& ids, const flat_set<account_id_type>& ) {
+         created.insert( ids.begin(), ids.end() );
+      }, false );
+      replayed.connect_changed_objects( [&]( const vector<object_id_type>&, const flat_set<account_id_type>& accounts ) {
+         changed_accounts.insert( accounts.begin(), accounts.end() );
+      }, true );
+      replayed.reindex( data_dir->path(), genesis_state );
+      BOOST_CHECK( created.count( alice_id ) );
+      BOOST_CHECK( changed_accounts.count( account_id_type() ) );
+      BOOST_CHECK( replayed._undo_db.enabled() );
+      replayed.close( false );
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( impacted_accounts_listener_test, database_fixture )
+{
+   try {
+      const account_id_type alice_id = create_account( "alice" ).id;
+      transfer( account_id_type(), alice_id, asset( 1000 ) );
+      generate_block();
+      const object_id_type alice_balance_id = db.get_index_type<account_balance_index>().indices().get<by_account_asset>()
+                                                 .find( boost::make_tuple( alice_id, asset_id_type() ) )->id;
+
+      std::set<object_id_type> changed_ids;
+      flat_set<account_id_type> changed_accounts;
+      boost::signals2::scoped_connection connection = db.connect_changed_objects(
+            [&]( const vector<object_id_type>& ids, const flat_set<account_id_type>& accounts ) {
+         changed_ids.insert( ids.begin(), ids.end() );
+         changed_accounts.insert( accounts.begin(), accounts.end() );
+      }, false );
+
+      // nobody asked for impacted accounts, so they are not computed, but the ids are still passed
+      transfer( account_id_type(), alice_id, asset( 1000 ) );
+      generate_block();
+      BOOST_CHECK( changed_ids.count( alice_balance_id ) );
+      BOOST_CHECK( changed_accounts.empty() );
+
+      // they are computed while a slot that wants them is connected
+      flat_set<account_id_type> wanted_accounts;
+      {
+         boost::signals2::scoped_connection wanting_connection = db.connect_changed_objects(
+               [&]( const vector<object_id_type>&, const flat_set<account_id_type>& accounts ) {
+            wanted_accounts.insert( accounts.begin(), accounts.end() );
+         }, true );
+         transfer( account_id_type(), alice_id, asset( 1000 ) );
+         generate_block();
+         BOOST_CHECK( wanted_accounts.count( alice_id ) );
+      }
+
+      changed_accounts.clear();
+      transfer( account_id_type(), alice_id, asset( 1000 ) );
+      generate_block();
+      BOOST_CHECK( changed_accounts.empty() );
+   } FC_LOG_AND_RETHROW()
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <limits>
+
+#include <graphene/account_history/account_history_plugin.hpp>
+#include <graphene/app/api.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace
+{
+   /// follows the history of account from the most recent operation, as the unindexed queries do
+   vector<operation_history_id_type> walk_history( const database& db, account_id_type account, int operation_type,
+                                                   uint32_t first_block, uint32_t end_block )
+   {
+      vector<operation_history_id_type> result;
+      const auto& by_seq_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_seq>();
+      auto range = by_seq_idx.equal_range( boost::make_tuple( account ) );
+      for( auto itr = range.second; itr != range.first; )
+      {
+         --itr;
+         const operation_history_object& op = itr->operation_id(db);
+         if( ( operation_type < 0 || op.op.which() == operation_type ) && op.block_num >= first_block && op.block_num < end_block )
+            result.push_back( itr->operation_id );
+      }
+      return result;
+   }
+
+   vector<operation_history_id_type> ids( const vector<operation_history_object>& ops )
+   {
+      vector<operation_history_id_type> result;
+      for( const operation_history_object& op : ops )
+         result.push_back( op.id );
+      return result;
+   }
+
+   boost::program_options::variables_map history_options( bool by_operation_type )
+   {
+      boost::program_options::variables_map options;
+      if( by_operation_type )
+         options.emplace( "index-history-by-operation-type", boost::program_options::variable_value( true, false ) );
+      return options;
+   }
+
+   /// the queries must give the same answers with and without index-history-by-operation-type
+   struct history_fixture : database_fixture
+   {
+      explicit history_fixture( bool by_operation_type )
+         : database_fixture( history_options( by_operation_type ) )
+      {
+         auto plugin = app.get_plugin<graphene::account_history::account_history_plugin>( "account_history" );
+         BOOST_REQUIRE( ( plugin->operation_type_history() != nullptr ) == by_operation_type );
+      }
+
+      void check_account_history_operations_by_type();
+      void check_account_history_by_time();
+   };
+
+   struct unindexed_history_fixture : history_fixture
+   {
+      unindexed_history_fixture() : history_fixture( false ) {}
+   };
+
+   struct indexed_history_fixture : history_fixture
+   {
+      indexed_history_fixture() : history_fixture( true ) {}
+   };
+}
+
+void history_fixture::check_account_history_operations_by_type()
+{
+   ACTORS( (alice)(bob) );
+   generate_block();
+   graphene::app::history_api hist_api( app );
+   const int transfer_type = operation::tag<transfer_operation>::value;
+   const int account_create_type = operation::tag<account_create_operation>::value;
+
+   for( int i = 0; i < 5; ++i )
+   {
+      transfer( account_id_type(), alice_id, asset(1000) );
+      transfer( alice_id, bob_id, asset(10) );
+      generate_block();
+   }
+
+   vector<operation_history_id_type> expected = walk_history( db, alice_id, transfer_type, 0, std::numeric_limits<uint32_t>::max() );
+   BOOST_REQUIRE_EQUAL( expected.size(), 10u );
+   BOOST_CHECK( ids( hist_api.get_account_history_operations( alice_id, transfer_type, operation_history_id_type(),
+                                                              operation_history_id_type(), 100 ) ) == expected );
+   BOOST_CHECK_EQUAL( hist_api.get_account_history_operations( alice_id, account_create_type, operation_history_id_type(),
+                                                               operation_history_id_type(), 100 ).size(), 1u );
+
+   // a page continues before the last operation of the previous one
+   vector<operation_history_object> first_page = hist_api.get_account_history_operations( alice_id, transfer_type,
+                                                                                        operation_history_id_type(),
+                                                                                        operation_history_id_type(), 4 );
+   BOOST_REQUIRE_EQUAL( first_page.size(), 4u );
+   vector<operation_history_object> next_page = hist_api.get_account_history_operations( alice_id, transfer_type,
+                                                                                       operation_history_id_type( first_page.back().id.instance() - 1 ),
+                                                                                       operation_history_id_type(), 100 );
+   BOOST_CHECK( ids( next_page ) == vector<operation_history_id_type>( expected.begin() + 4, expected.end() ) );
+
+   // stop excludes it and everything before it
+   vector<operation_history_object> until_stop = hist_api.get_account_history_operations( alice_id, transfer_type,
+                                                                                        operation_history_id_type(),
+                                                                                        expected[6], 100 );
+   BOOST_CHECK( ids( until_stop ) == vector<operation_history_id_type>( expected.begin(), expected.begin() + 6 ) );
+
+   // operations of a popped block leave the index
+   transfer( alice_id, bob_id, asset(10) );
+   generate_block();
+   BOOST_CHECK_EQUAL( hist_api.get_account_history_operations( alice_id, transfer_type, operation_history_id_type(),
+                                                               operation_history_id_type(), 100 ).size(), 11u );
+   db.pop_block();
+   BOOST_CHECK( ids( hist_api.get_account_history_operations( alice_id, transfer_type, operation_history_id_type(),
+                                                              operation_history_id_type(), 100 ) ) == expected );
+}
+
+void history_fixture::check_account_history_by_time()
+{
+   ACTORS( (alice)(bob) );
+   generate_block();
+   graphene::app::history_api hist_api( app );
+   const int transfer_type = operation::tag<transfer_operation>::value;
+
+   vector<signed_block> blocks;
+   for( int i = 0; i < 4; ++i )
+   {
+      transfer( account_id_type(), alice_id, asset(1000) );
+      transfer( alice_id, bob_id, asset(10) );
+      blocks.push_back( generate_block() );
+      generate_blocks( 3 );
+   }
+
+   // the range includes its start and excludes its end
+   vector<operation_history_object> middle = hist_api.get_account_history_by_time( alice_id, transfer_type,
+                                                                                  blocks[1].timestamp, blocks[3].timestamp );
+   BOOST_CHECK( ids( middle ) == walk_history( db, alice_id, transfer_type, blocks[1].block_num(), blocks[3].block_num() ) );
+   BOOST_CHECK_EQUAL( middle.size(), 4u );
+
+   vector<operation_history_id_type> expected = walk_history( db, alice_id, -1, blocks[0].block_num(), db.head_block_num() + 1 );
+   BOOST_REQUIRE_EQUAL( expected.size(), 8u );
+   vector<operation_history_object> all = hist_api.get_account_history_by_time( alice_id, -1, blocks[0].timestamp,
+                                                                               db.head_block_time() + 1 );
+   BOOST_CHECK( ids( all ) == expected );
+
+   // a page continues before the last operation of the previous one
+   vector<operation_history_object> first_page = hist_api.get_account_history_by_time( alice_id, -1, blocks[0].timestamp,
+                                                                                      db.head_block_time() + 1, 3 );
+   BOOST_REQUIRE_EQUAL( first_page.size(), 3u );
+   vector<operation_history_object> next_page = hist_api.get_account_history_by_time( alice_id, -1, blocks[0].timestamp,
+                                                                                     db.head_block_time() + 1, 100,
+                                                                                     operation_history_id_type( first_page.back().id.instance() - 1 ) );
+   BOOST_CHECK( ids( next_page ) == vector<operation_history_id_type>( expected.begin() + 3, expected.end() ) );
+
+   BOOST_CHECK( hist_api.get_account_history_by_time( alice_id, transfer_type, db.head_block_time() + 1,
+                                                      db.head_block_time() + 10 ).empty() );
+}
+
+BOOST_AUTO_TEST_SUITE( history_api_tests )
+
+BOOST_FIXTURE_TEST_CASE( get_account_history_operations_by_type, unindexed_history_fixture )
+{ try {
+   check_account_history_operations_by_type();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( get_account_history_operations_by_type_indexed, indexed_history_fixture )
+{ try {
+   check_account_history_operations_by_type();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( get_account_history_by_time, unindexed_history_fixture )
+{ try {
+   check_account_history_by_time();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( get_account_history_by_time_indexed, indexed_history_fixture )
+{ try {
+   check_account_history_by_time();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -412,4 +412,80 @@ BOOST_AUTO_TEST_CASE( check_passes_for_duplicated_betting_market_or_group )
     }
 }
 
+BOOST_AUTO_TEST_CASE( check_follows_removed_and_restored_proposals )
+{
+    try
+    {
+        ACTORS((alice))
+
+        auto transfer = make_transfer_operation(account_id_type(), alice_id, asset(500));
+        proposal_create_operation nested_proposal;
+        nested_proposal.proposed_ops.push_back(op_wrapper(transfer));
+        create_proposal(*this, {nested_proposal});
+
+        auto trx = make_signed_transaction_with_proposed_operation(*this, {transfer});
+        BOOST_CHECK_THROW(db.check_tansaction_for_duplicated_operations(trx), fc::exception);
+
+        const auto& proposals = db.get_index_type<proposal_index>().indices().get<by_id>();
+        BOOST_REQUIRE_EQUAL(proposals.size(), 1u);
+        {
+            auto session = db._undo_db.start_undo_session();
+            db.remove(*proposals.begin());
+            BOOST_CHECK_NO_THROW(db.check_tansaction_for_duplicated_operations(trx));
+        }
+        BOOST_CHECK_THROW(db.check_tansaction_for_duplicated_operations(trx), fc::exception);
+    }
+    catch( const fc::exception& e )
+    {
+        edump((e.to_detail_string()));
+        throw;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( check_follows_pending_transactions )
+{
+    try
+    {
+        ACTORS((alice))
+        generate_block();
+
+        auto first_transfer = make_transfer_operation(account_id_type(), alice_id, asset(500));
+        auto second_transfer = make_transfer_operation(account_id_type(), alice_id, asset(600));
+        auto first_trx = make_signed_transaction_with_proposed_operation(*this, {first_transfer});
+        auto second_trx = make_signed_transaction_with_proposed_operation(*this, {second_transfer});
+
+        // pushed, then dropped again
+        push_proposal(*this, alice, {first_transfer});
+        BOOST_CHECK_THROW(db.check_tansaction_for_duplicated_operations(first_trx), fc::exception);
+        db.clear_pending();
+        BOOST_CHECK_NO_THROW(db.check_tansaction_for_duplicated_operations(first_trx));
+
+        // pushed, then included in a block; pending transactions are pushed again after the block
+        push_proposal(*this, alice, {first_transfer});
+        generate_block();
+        BOOST_CHECK_THROW(db.check_tansaction_for_duplicated_operations(first_trx), fc::exception);
+
+        // the popped block's transaction is neither pending nor open
+        db.pop_block();
+        BOOST_CHECK_NO_THROW(db.check_tansaction_for_duplicated_operations(first_trx));
+
+        // the next block pushes the popped transaction again
+        push_proposal(*this, alice, {second_transfer});
+        BOOST_CHECK_THROW(db.check_tansaction_for_duplicated_operations(second_trx), fc::exception);
+        BOOST_CHECK_NO_THROW(db.check_tansaction_for_duplicated_operations(first_trx));
+        generate_block();
+        BOOST_CHECK_THROW(db.check_tansaction_for_duplicated_operations(first_trx), fc::exception);
+        BOOST_CHECK_THROW(db.check_tansaction_for_duplicated_operations(second_trx), fc::exception);
+
+        db.clear_pending();
+        BOOST_CHECK_NO_THROW(db.check_tansaction_for_duplicated_operations(first_trx));
+        BOOST_CHECK_THROW(db.check_tansaction_for_duplicated_operations(second_trx), fc::exception);
+    }
+    catch( const fc::exception& e )
+    {
+        edump((e.to_detail_string()));
+        throw;
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/snapshot/binary_snapshot.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::snapshot_plugin;
+
+BOOST_FIXTURE_TEST_SUITE( snapshot_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( binary_snapshot_round_trip )
+{
+   try {
+      const account_id_type alice_id = create_account( "alice" ).id;
+      transfer( account_id_type(), alice_id, asset( 1000 ) );
+      generate_blocks( 5 );
+
+      auto packed_objects = []( const graphene::db::index& idx ) -> vector< vector<char> > {
+         vector< vector<char> > result;
+         idx.inspect_all_objects( [&result]( const graphene::db::object& o ) {
+            result.push_back( o.pack() );
+         });
+         return result;
+      };
+
+      for( bool compress : { false, true } )
+      {
+         BOOST_TEST_MESSAGE( compress ? "Compressed snapshot" : "Uncompressed snapshot" );
+         fc::temp_directory snapshot_dir( graphene::utilities::temp_directory_path() );
+         const fc::path file = snapshot_dir.path() / "snapshot.bin";
+         write_binary_snapshot( capture_binary_snapshot( db, compress ), file );
+
+         // read it back the way snapshot_util does
+         const extracted_binary_snapshot extracted = extract_binary_snapshot( file, snapshot_dir.path() / "data" );
+         BOOST_CHECK_EQUAL( extracted.header.compressed, compress );
+         BOOST_CHECK_EQUAL( extracted.header.block_num, db.head_block_num() );
+         BOOST_CHECK( extracted.header.block_id == db.head_block_id() );
+         BOOST_CHECK( extracted.header.chain_id == db.get_chain_id() );
+         BOOST_CHECK_EQUAL( extracted.files.size(), extracted.header.index_count );
+
+         database loaded;
+         loaded.object_database::open( snapshot_dir.path() / "data", extracted.files );
+         BOOST_CHECK( loaded.head_block_id() == db.head_block_id() );
+         BOOST_CHECK( loaded.get( alice_id ).name == "alice" );
+
+         uint32_t compared = 0;
+         loaded.inspect_all_indexes( [&]( const graphene::db::index& idx ) {
+            const graphene::db::index& original = db.get_index( idx.object_space_id(), idx.object_type_id() );
+            BOOST_CHECK( packed_objects( idx ) == packed_objects( original ) );
+            ++compared;
+         });
+         BOOST_CHECK( compared > 0 );
+      }
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2255,6 +2255,104 @@ BOOST_FIXTURE_TEST_CASE( massive, database_fixture )
 }
 #endif
 
+// Test of checking only the tournaments whose matches changed,
+// a full scan must never find a match that should have been started
+BOOST_FIXTURE_TEST_CASE( match_activity, database_fixture )
+{
+    try
+    {
+        ACTORS((nathan)(alice)(bob)(carol)(dave));
+
+        tournaments_helper tournament_helper(*this);
+        fc::ecc::private_key nathan_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("nathan")));
+
+        transfer(committee_account, nathan_id, asset(1000000000));
+        transfer(committee_account, alice_id, asset(2000000));
+        transfer(committee_account, bob_id, asset(2000000));
+        transfer(committee_account, carol_id, asset(2000000));
+        transfer(committee_account, dave_id, asset(2000000));
+        upgrade_to_lifetime_member(nathan);
+
+        asset buy_in = asset(12000);
+        tournament_id_type tournament_id = tournament_helper.create_tournament(nathan_id, nathan_priv_key, buy_in, 4);
+        tournament_helper.join_tournament(tournament_id, alice_id, alice_id, fc::ecc::private_key::regenerate(fc::sha256::hash(string("alice"))), buy_in);
+        tournament_helper.join_tournament(tournament_id, bob_id, bob_id, fc::ecc::private_key::regenerate(fc::sha256::hash(string("bob"))), buy_in);
+        tournament_helper.join_tournament(tournament_id, carol_id, carol_id, fc::ecc::private_key::regenerate(fc::sha256::hash(string("carol"))), buy_in);
+        tournament_helper.join_tournament(tournament_id, dave_id, dave_id, fc::ecc::private_key::regenerate(fc::sha256::hash(string("dave"))), buy_in);
+
+        for (unsigned i = 0; i < 10 && tournament_id(db).get_state() != tournament_state::in_progress; ++i)
+            generate_block();
+        BOOST_REQUIRE(tournament_id(db).get_state() == tournament_state::in_progress);
+
+        const auto& activity = dynamic_cast<const primary_index<match_index>&>(db.get_index_type<match_index>()).get_secondary_index<match_activity_index>();
+        const tournament_details_object& tournament_details = tournament_id(db).tournament_details_id(db);
+        BOOST_REQUIRE_EQUAL(tournament_details.matches.size(), 3u);
+        const match_id_type first_match_id = tournament_details.matches.front();
+        const match_id_type final_match_id = tournament_details.matches.back();
+        BOOST_REQUIRE(final_match_id(db).get_state() == match_state::waiting_on_previous_matches);
+
+        // touching a match marks its tournament
+        {
+            auto session = db._undo_db.start_undo_session();
+            db.modify(first_match_id(db), [](match_object&) {});
+            BOOST_CHECK(activity.active_tournaments().count(tournament_id));
+        }
+
+        // checks every tournament in progress the way it was done before the index, and reports whether
+        // that would start a match which the checks of the marked tournaments did not start
+        auto full_scan_starts_a_match = [&]() -> bool {
+            auto count_matches_in_progress = [&]() -> size_t {
+                const auto& matches = db.get_index_type<match_index>().indices().get<by_id>();
+                return std::count_if(matches.begin(), matches.end(), [](const match_object& m) {
+                    return m.get_state() == match_state::match_in_progress;
+                });
+            };
+            auto session = db._undo_db.start_undo_session();
+            const auto in_progress_before = count_matches_in_progress();
+            for (const tournament_object& tournament : db.get_index_type<tournament_index>().indices())
+                if (tournament.get_state() == tournament_state::in_progress)
+                    tournament.check_for_new_matches_to_start(db);
+            return count_matches_in_progress() != in_progress_before;
+        };
+
+        BOOST_TEST_MESSAGE( "Playing the first round" );
+        for (unsigned i = 0; i < 100 && final_match_id(db).get_state() == match_state::waiting_on_previous_matches; ++i)
+        {
+            tournament_helper.play_games();
+            generate_block();
+            BOOST_CHECK(!full_scan_starts_a_match());
+        }
+        BOOST_REQUIRE(final_match_id(db).get_state() == match_state::match_in_progress);
+
+        BOOST_TEST_MESSAGE( "Undoing the block that started the final" );
+        optional<signed_block> final_block = db.fetch_block_by_number(db.head_block_num());
+        BOOST_REQUIRE(final_block.valid());
+        db.pop_block();
+        BOOST_CHECK(final_match_id(db).get_state() == match_state::waiting_on_previous_matches);
+        BOOST_CHECK(activity.active_tournaments().count(tournament_id));
+        db.push_block(*final_block, ~0);
+        BOOST_CHECK(final_match_id(db).get_state() == match_state::match_in_progress);
+        BOOST_CHECK(!full_scan_starts_a_match());
+
+        BOOST_TEST_MESSAGE( "Reloading the database" );
+        db.close(false);
+        database reloaded;
+        reloaded.open(data_dir->path(), [this]{ return genesis_state; });
+        const auto& reloaded_activity = dynamic_cast<const primary_index<match_index>&>(reloaded.get_index_type<match_index>()).get_secondary_index<match_activity_index>();
+        BOOST_CHECK(reloaded_activity.active_tournaments().count(tournament_id));
+        BOOST_CHECK(final_match_id(reloaded).get_state() == match_state::match_in_progress);
+        reloaded.generate_block(reloaded.get_slot_time(1), reloaded.get_scheduled_witness(1), init_account_priv_key, ~0);
+        BOOST_CHECK(tournament_id(reloaded).get_state() == tournament_state::in_progress);
+        BOOST_CHECK(final_match_id(reloaded).get_state() == match_state::match_in_progress);
+        reloaded.close(false);
+    }
+    catch (fc::exception& e)
+    {
+        edump((e.to_detail_string()));
+        throw;
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 //#define BOOST_TEST_MODULE "C++ Unit Tests for Graphene Blockchain Database"